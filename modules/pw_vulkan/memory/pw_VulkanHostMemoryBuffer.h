@@ -0,0 +1,170 @@
+/*
+  ==============================================================================
+
+   This file is part of the Parawave Vulkan C++ library.
+
+   The code included in this file is provided under the terms of the ISC license
+   https://opensource.org/licenses/ISC.
+
+   Copyright (c) 2021 - Parawave Audio (https://parawave-audio.com/vulkan-cpp-library)
+
+   Permission to use, copy, modify, and/or distribute this software for any 
+   purpose with or without fee is hereby granted, provided that the above 
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES 
+   WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF 
+   MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+   SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES 
+   WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+   OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN 
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace parawave
+{
+
+//==============================================================================
+/**
+    VulkanHostMemoryBuffer
+
+    A buffer bound to memory that was allocated by the application and imported
+    with VK_EXT_external_memory_host. The device accesses the host allocation
+    directly, so data doesn't have to be copied into a staging buffer first.
+
+    The host memory must stay allocated until the buffer is destroyed and every
+    command that uses the buffer has completed. Check canImport() before creating
+    the buffer and isValid() afterwards, the driver may still reject a pointer.
+*/
+class VulkanHostMemoryBuffer final
+{
+private:
+    VulkanHostMemoryBuffer() = delete;
+
+    static constexpr auto handleType = vk::ExternalMemoryHandleTypeFlagBits::eHostAllocationEXT;
+
+public:
+    VulkanHostMemoryBuffer(const VulkanDevice& device_, void* hostPointer_, vk::DeviceSize size_, vk::BufferUsageFlags usage) :
+        device(device_), hostPointer(hostPointer_), size(size_)
+    {
+        jassert(canImport(device, hostPointer, size));
+
+        vk::Result result;
+        vk::MemoryHostPointerPropertiesEXT hostPointerProperties;
+
+        std::tie(result, hostPointerProperties) = device.getHandle().getMemoryHostPointerPropertiesEXT(handleType, hostPointer).asTuple();
+
+        if (result != vk::Result::eSuccess || hostPointerProperties.memoryTypeBits == 0)
+        {
+            PW_DBG_V("Host pointer can't be imported : " << vk::to_string(result));
+            return;
+        }
+
+        const auto externalCreateInfo = vk::ExternalMemoryBufferCreateInfo().setHandleTypes(handleType);
+
+        buffer.reset(new VulkanBuffer(device, vk::BufferCreateInfo()
+            .setPNext(&externalCreateInfo)
+            .setSize(size)
+            .setUsage(usage)
+            .setSharingMode(vk::SharingMode::eExclusive)));
+
+        const auto memoryRequirements = buffer->getMemoryRequirements();
+        const auto memoryTypeBits = memoryRequirements.memoryTypeBits & hostPointerProperties.memoryTypeBits;
+
+        if (memoryTypeBits == 0 || memoryRequirements.size > size)
+        {
+            buffer.reset();
+            return;
+        }
+
+        const auto importInfo = vk::ImportMemoryHostPointerInfoEXT()
+            .setHandleType(handleType)
+            .setPHostPointer(hostPointer);
+
+        memory.reset(new VulkanDeviceMemory(device, vk::MemoryAllocateInfo()
+            .setPNext(&importInfo)
+            .setAllocationSize(size)
+            .setMemoryTypeIndex(getMemoryTypeIndex(memoryTypeBits))));
+
+        if (! memory->getHandle())
+        {
+            memory.reset();
+            buffer.reset();
+            return;
+        }
+
+        result = device.getHandle().bindBufferMemory(buffer->getHandle(), memory->getHandle(), 0);
+        PW_CHECK_VK_RESULT_SUCCESS(result, "Failed to bind imported host memory for buffer.");
+    }
+
+    ~VulkanHostMemoryBuffer()
+    {
+        // Destroy the buffer before the memory it's bound to
+        buffer.reset();
+        memory.reset();
+    }
+
+    /** True if the device supports the import and the pointer and size are aligned to the
+        minimum imported host pointer alignment. */
+    static bool canImport(const VulkanDevice& device, const void* hostPointer, vk::DeviceSize size) noexcept
+    {
+        const auto alignment = device.getMinImportedHostPointerAlignment();
+
+        return alignment > 0 && hostPointer != nullptr && size > 0
+            && (reinterpret_cast<uintptr_t>(hostPointer) % alignment) == 0
+            && (size % alignment) == 0;
+    }
+
+    bool isValid() const noexcept { return memory != nullptr; }
+
+    const VulkanBuffer& getBuffer() const noexcept { jassert(isValid()); return *buffer; }
+
+    void* getHostPointer() const noexcept { return hostPointer; }
+
+    vk::DeviceSize getSize() const noexcept { return size; }
+
+    /** True if the range is part of the imported host allocation. */
+    bool contains(const void* data, vk::DeviceSize dataSize) const noexcept
+    {
+        const auto* begin = static_cast<const uint8_t*>(hostPointer);
+        const auto* pointer = static_cast<const uint8_t*>(data);
+
+        return pointer >= begin && static_cast<vk::DeviceSize>(pointer - begin) + dataSize <= size;
+    }
+
+    /** The offset of a host address inside of the buffer. */
+    vk::DeviceSize getOffset(const void* data) const noexcept
+    {
+        jassert(contains(data, 0));
+        return static_cast<vk::DeviceSize>(static_cast<const uint8_t*>(data) - static_cast<const uint8_t*>(hostPointer));
+    }
+
+private:
+    uint32_t getMemoryTypeIndex(uint32_t memoryTypeBits) const
+    {
+        const auto& memoryProperties = device.getPhysicalDevice().getMemoryProperties();
+        const auto ranking = VulkanMemoryUsage::forIntent(VulkanMemoryUsage::Intent::staging).rankMemoryTypes(memoryProperties, memoryTypeBits);
+
+        if (! ranking.isEmpty())
+            return ranking.getFirst();
+
+        return static_cast<uint32_t>(juce::findHighestSetBit(memoryTypeBits & (~memoryTypeBits + 1)));
+    }
+
+private:
+    const VulkanDevice& device;
+
+    void* const hostPointer;
+    const vk::DeviceSize size;
+
+    std::unique_ptr<VulkanBuffer> buffer;
+    std::unique_ptr<VulkanDeviceMemory> memory;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VulkanHostMemoryBuffer)
+};
+
+} // namespace parawave
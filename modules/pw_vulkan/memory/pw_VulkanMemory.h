@@ -35,25 +35,23 @@ namespace parawave
     A fixed block of device memory that can be used to acquire/dispose memory 
     ranges. Optionally mapped if the MemoryPropertyFlag is specified 
     as 'eHostVisible'. 
+
+    Ranges are managed by a VulkanRangeAllocator, a two-level segregated fit 
+    (TLSF) allocator that finds a fitting free range in constant time.
+
+    A dedicated block is allocated for exactly one resource and is not shared
+    with other ranges.
 */
 class VulkanMemory final
 {
-private:
-    enum
-    {
-        minNumRanges = 16
-    };
-
 public:
-    VulkanMemory(const VulkanDevice& _device, vk::DeviceSize memorySize_, uint32_t memoryTypeIndex_) :
-        device(_device), memory(_device, vk::MemoryAllocateInfo(memorySize_, memoryTypeIndex_)), memorySize(memorySize_), memoryTypeIndex(memoryTypeIndex_)
+    VulkanMemory(const VulkanDevice& _device, const vk::MemoryAllocateInfo& allocateInfo, bool dedicated_ = false) :
+        device(_device), memory(_device, allocateInfo), memorySize(allocateInfo.allocationSize), memoryTypeIndex(allocateInfo.memoryTypeIndex), dedicated(dedicated_),
+        propertyFlags(_device.getPhysicalDevice().getMemoryProperties().memoryTypes[allocateInfo.memoryTypeIndex].propertyFlags),
+        allocator(memorySize)
     {
-        ranges.add(VulkanMemoryRange(*this, memorySize, 0, true));
-
-        const auto& physicalDevice = device.getPhysicalDevice();
-        
         // If the used memory type is host visible the device memory, map the entire range!
-        const auto memoryTypeProperty = physicalDevice.getMemoryProperties().memoryTypes[memoryTypeIndex].propertyFlags;
+        const auto memoryTypeProperty = propertyFlags;
         if ((memoryTypeProperty & vk::MemoryPropertyFlagBits::eHostVisible) == vk::MemoryPropertyFlagBits::eHostVisible)
         {
             vk::Result result;
@@ -64,10 +62,13 @@ public:
             PW_CHECK_VK_RESULT_SUCCESS(result, "Failed to map device memory.");
         }
 
-        PW_DBG_V("Allocated " + juce::File::descriptionOfSizeInBytes(memorySize) + " (" + juce::String(memorySize) + " bytes) device memory. Type: " 
-            << vk::to_string(memoryTypeProperty));
+        PW_DBG_V("Allocated " + juce::File::descriptionOfSizeInBytes(memorySize) + " (" + juce::String(memorySize) + " bytes) " 
+            << (dedicated ? "dedicated " : "") << "device memory. Type: " << vk::to_string(memoryTypeProperty));
     }
 
+    VulkanMemory(const VulkanDevice& _device, vk::DeviceSize memorySize_, uint32_t memoryTypeIndex_) :
+        VulkanMemory(_device, vk::MemoryAllocateInfo(memorySize_, memoryTypeIndex_)) {}
+
     ~VulkanMemory()
     {
         if (isHostVisible())
@@ -93,247 +94,184 @@ public:
 
     bool isHostVisible() const noexcept { return getData() != nullptr; }
 
-    bool contains(const VulkanMemoryRange& range) const noexcept { return ranges.contains(range); }
+    bool isDedicated() const noexcept { return dedicated; }
 
-    bool isFree() const noexcept 
-    {
-        for (auto& range : ranges)
-        {
-            if (!range.isFree())
-                return false;
-        }
+    vk::MemoryPropertyFlags getPropertyFlags() const noexcept { return propertyFlags; }
 
-        return true;
-    }
+    /** Host writes to non-coherent memory must be flushed before the device reads them, 
+        device writes must be invalidated before the host reads them. */
+    bool isHostCoherent() const noexcept { return bool(propertyFlags & vk::MemoryPropertyFlagBits::eHostCoherent); }
 
-    bool acquireRange(VulkanMemoryRange& destRange, vk::DeviceSize rangeSize, vk::DeviceSize rangeAlignment)
-    {
-        // Block too small for the requested range size
-        if(rangeSize > memorySize)
-            return false;
-
-        int index;
-        vk::DeviceSize newSize;
-
-        std::tie(index, newSize) = findFreeRange(rangeSize, rangeAlignment);
-
-        if (index == -1 || newSize == 0)
-            return false;
+    /** Host cached memory is fast to read on the CPU, unlike write-combined memory. */
+    bool isHostCached() const noexcept { return bool(propertyFlags & vk::MemoryPropertyFlagBits::eHostCached); }
 
-        {
-            auto& range = ranges.getReference(index);
-
-            range.memorySize = newSize;
-
-            // Move offset to the required alignment
-            if(rangeAlignment != 0)
-            {
-                const auto delta = range.memoryOffset % rangeAlignment;
-                if (delta != 0)
-                    range.memoryOffset += rangeAlignment - delta;
-            }
-
-            // If it's a perfect fit, just return the range
-            if(range.memorySize == rangeSize) 
-            {
-                range.free = false;
-                destRange = range;
-
-                return true;
-            }
-        }
-
-        vk::DeviceSize newRangeSize;
-        vk::DeviceSize newRangeOffset;
-
-        // If the requested range is smaller than the found range, split it up!
-        {
-            auto& range = ranges.getReference(index);
-
-            newRangeSize = range.memorySize - rangeSize;
-            newRangeOffset = range.memoryOffset + rangeSize;
-
-            range.memorySize = rangeSize;
-            range.free = false;
-
-            destRange = range;
-        }
+    /** The mapped range expanded to whole non-coherent atoms, as required by flush and invalidate. */
+    vk::MappedMemoryRange getMappedRange(vk::DeviceSize rangeOffset, vk::DeviceSize rangeSize) const noexcept
+    {
+        const auto atomSize = std::max(device.getPhysicalDevice().getLimits().nonCoherentAtomSize, vk::DeviceSize(1));
 
-        ranges.add(VulkanMemoryRange(*this, newRangeSize, newRangeOffset));
+        const auto begin = (rangeOffset / atomSize) * atomSize;
+        const auto end = std::min(((rangeOffset + rangeSize + atomSize - 1) / atomSize) * atomSize, memorySize);
 
-        return true;
+        return vk::MappedMemoryRange(memory.getHandle(), begin, end - begin);
     }
 
-    void disposeRange(const VulkanMemoryRange& range, bool defragmentAfter = true) noexcept
+    /** Make host writes visible to the device. Does nothing for coherent memory. */
+    void flush(vk::DeviceSize rangeOffset, vk::DeviceSize rangeSize) const noexcept
     {
-        auto iterator(std::find(ranges.begin(), ranges.end(), range));
-        jassert(iterator != ranges.end());
-
-        iterator->free = true;
+        if (isHostVisible() && ! isHostCoherent() && rangeSize > 0)
+            flush(device, { getMappedRange(rangeOffset, rangeSize) });
+    }
 
-        if(defragmentAfter)
-            defragmentRanges();
+    /** Make device writes visible to the host. Does nothing for coherent memory. */
+    void invalidate(vk::DeviceSize rangeOffset, vk::DeviceSize rangeSize) const noexcept
+    {
+        if (isHostVisible() && ! isHostCoherent() && rangeSize > 0)
+            invalidate(device, { getMappedRange(rangeOffset, rangeSize) });
     }
 
-    void defragmentRanges()
+    /** Flush a batch of ranges, possibly of several blocks, with a single call. */
+    static void flush(const VulkanDevice& device, const std::vector<vk::MappedMemoryRange>& ranges) noexcept
     {
-        // Quick Merge: If all ranges are free, merge all into one!
-        if (mergeAllRanges())
+        if (ranges.empty())
             return;
 
-        sortRanges();
+        jassert(device.getHandle());
+        const auto result = device.getHandle().flushMappedMemoryRanges(ranges);
 
-        //DBG("Before Fragmentation:");
-        //printRanges();
+        PW_CHECK_VK_RESULT_SUCCESS(result, "Failed to flush mapped memory ranges.");
+    }
 
-        mergeAdjacentRanges();
-        removeEmptyRanges();
-        
-        if (ranges.size() > 0)
-        {
-            // First : Move offset to left of the allocation
-            {
-                auto& range = ranges.getReference(0);
-                if (range.isFree())
-                    range.memoryOffset = 0;
-            }
-            
-            // Last : Increase size so the range fits the max allocation size
-            {
-                auto& range = ranges.getReference(ranges.size() - 1);
-                if (range.isFree() && range.getEnd() < memorySize)
-                    range.memorySize = memorySize - range.getOffset();
-            }
-        }
+    /** Invalidate a batch of ranges, possibly of several blocks, with a single call. */
+    static void invalidate(const VulkanDevice& device, const std::vector<vk::MappedMemoryRange>& ranges) noexcept
+    {
+        if (ranges.empty())
+            return;
 
-        //DBG("After Fragmentation:");
-        //printRanges();
+        jassert(device.getHandle());
+        const auto result = device.getHandle().invalidateMappedMemoryRanges(ranges);
 
-        /** 
-            TODO 
-            If there are unassigned memory ranges due to alignment offset shift,
-            these could cause fragmentation in the long term run. 
-            
-            Resize free ranges to the start of the next range!
-        */
+        PW_CHECK_VK_RESULT_SUCCESS(result, "Failed to invalidate mapped memory ranges.");
     }
 
-private:
-    struct RangeComparator
+    /** The buffer that covers the entire block, used by suballocated VulkanMemoryBuffers. 
+        Returns nullptr if the block has no buffer. */
+    const VulkanBuffer* getBuffer() const noexcept { return buffer.get(); }
+
+    /** Create a buffer over the entire block, if there is none yet. The memory type 
+        of the block must be supported by a buffer with the requested usage. */
+    const VulkanBuffer& getOrCreateBuffer(vk::BufferUsageFlags usage)
     {
-        static int compareElements(const VulkanMemoryRange& first, const VulkanMemoryRange& second) noexcept
+        if (buffer == nullptr)
         {
-            if (first.getOffset() < second.getOffset())
-                return -1;
-            else if (first.getOffset() > second.getOffset())
-                return 1;
+            buffer = std::make_unique<VulkanBuffer>(device, memorySize, usage);
+            
+            jassert(buffer->getMemoryRequirements().memoryTypeBits & (1U << memoryTypeIndex));
+
+            jassert(device.getHandle() && buffer->getHandle());
+            const auto result = device.getHandle().bindBufferMemory(buffer->getHandle(), memory.getHandle(), 0);
 
-            return 0;
+            PW_CHECK_VK_RESULT_SUCCESS(result, "Failed to bind device memory for block buffer.");
         }
-    };
 
-    // Sort the Ranges by Offset
-    void sortRanges()
-    {
-        const RangeComparator comparator;
-        ranges.sort(comparator);
+        jassert((buffer->getUsage() & usage) == usage);
+        return *buffer;
     }
 
-    void removeEmptyRanges()
-    {
-        ranges.removeIf ([](const VulkanMemoryRange& range) { return range.isEmpty(); });
+    /** True if the range is a live allocation of this block. The generation of the handle 
+        must match the slot, so a stale handle of a disposed range fails, even if its slot 
+        was reused by another allocation. */
+    bool contains(const VulkanMemoryRange& range) const noexcept 
+    { 
+        const auto& handle = range.getHandle();
+
+        return range.getMemoryBlock() == this && allocator.isAllocated(handle.slot, handle.generation, range.getOffset());
     }
 
-    // Merge adjacent free ranges into one, zero size the remaining range
-    void mergeAdjacentRanges()
-    {
-        for (int i = ranges.size(); --i >= 0;)
-        {
-            if (i - 1 < 0)
-                continue;
+    bool isFree() const noexcept { return allocator.isFree(); }
 
-            auto& right = ranges.getReference(i);
-            if (!right.isFree())
-                continue;
+    int getNumAllocations() const noexcept { return allocator.getNumAllocations(); }
 
-            auto& left = ranges.getReference(i - 1);
-            if (!left.isFree())
-                continue;
+    /** The size of all acquired ranges, without the free space in between. */
+    vk::DeviceSize getAllocatedSize() const noexcept { return allocator.getAllocatedSize(); }
 
-            const auto distance = right.getEnd() - left.getEnd();
-               
-            left.memorySize += distance;
+    vk::DeviceSize getFreeSize() const noexcept { return memorySize - getAllocatedSize(); }
 
-            right.memoryOffset = 0;
-            right.memorySize = 0;
-        }
-    }
+    /** A pinned range can't be moved by its owner, so the block can't be compacted. */
+    void pinRange() noexcept { ++numPinnedRanges; }
 
-    bool mergeAllRanges()
-    {
-        for (const auto& range : ranges)
-        {
-            if (!range.isFree())
-                return false;
-        }
+    void unpinRange() noexcept 
+    { 
+        jassert(numPinnedRanges > 0);
+        --numPinnedRanges; 
+    }
 
-        ranges.clearQuick();
-        ranges.add(VulkanMemoryRange(*this, memorySize, 0, true));
+    bool hasPinnedRanges() const noexcept { return numPinnedRanges > 0; }
 
-        return true;
+    VulkanMemoryStatistics getStatistics() const
+    {
+        VulkanMemoryStatistics statistics;
+
+        statistics.memoryTypeIndex = static_cast<int>(memoryTypeIndex);
+        statistics.numBlocks = 1;
+        statistics.numDedicatedBlocks = dedicated ? 1 : 0;
+        statistics.numAllocations = getNumAllocations();
+        statistics.blockBytes = memorySize;
+        statistics.allocatedBytes = getAllocatedSize();
+        statistics.freeBytes = getFreeSize();
+        statistics.numFreeRanges = allocator.getNumFreeRanges();
+        statistics.largestFreeRange = allocator.getLargestFreeRange();
+
+        return statistics;
     }
 
-    std::pair<int, vk::DeviceSize> findFreeRange(vk::DeviceSize rangeSize, vk::DeviceSize rangeAlignment) const noexcept
+    bool acquireRange(VulkanMemoryRange& destRange, vk::DeviceSize rangeSize, vk::DeviceSize rangeAlignment)
     {
-        int i = 0;
+        VulkanRangeAllocator::Allocation allocation;
 
-        for (auto& range : ranges)
-        {
-            if (range.isFree())
-            {
-                auto newSize = range.getSize();
-
-                // If there is an alignment requirement, the offset shifts and the available size will be reduced
-                if(rangeAlignment != 0)
-                {
-                    const auto delta = range.getOffset() % rangeAlignment;
-                    if (delta != 0)
-                        newSize -= rangeAlignment - delta;
-                }
-               
-                // Is the (due to alignment) reduced size still big enough?
-                if (newSize >= rangeSize)
-                    return std::make_pair(i, newSize);
-            }
-
-            ++i;
-        }
+        if (! allocator.allocate(allocation, rangeSize, rangeAlignment))
+            return false;
 
-        return std::make_pair(-1, vk::DeviceSize(0));
+        destRange = VulkanMemoryRange(*this, allocation.size, allocation.offset, false);
+        destRange.handle.slot = allocation.slot;
+        destRange.handle.generation = allocation.generation;
+        
+        return true;
     }
 
-    void printRanges()
+    void disposeRange(const VulkanMemoryRange& range) noexcept
     {
-        DBG("Memory Ranges: ");
-
-        for (int i = 0; i < ranges.size(); ++i)
+        // Range was not acquired from this block or is already disposed
+        if (!contains(range))
         {
-            DBG("Range [" << (ranges[i].isFree() ? " " : "X") << "] [offset = " << ranges[i].getOffset() << ", size = " << ranges[i].getSize() << "]");
+            jassertfalse;
+            return;
         }
 
-        DBG("Total [offset = " << 0 << ", size = " << memorySize << "]");
+        allocator.free(range.getHandle().slot);
     }
 
+private:
+    void printRanges() const { allocator.printRanges(); }
+
 private:
     const VulkanDevice& device;
     const VulkanDeviceMemory memory;
 
+    // Destroyed before the device memory it's bound to
+    std::unique_ptr<VulkanBuffer> buffer;
+
     const vk::DeviceSize memorySize;
     const uint32_t memoryTypeIndex;
 
+    const bool dedicated;
+    const vk::MemoryPropertyFlags propertyFlags;
+
     void* data = nullptr;
 
-    juce::Array<VulkanMemoryRange, juce::DummyCriticalSection, minNumRanges> ranges;
+    VulkanRangeAllocator allocator;
+
+    int numPinnedRanges = 0;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VulkanMemory)
 };
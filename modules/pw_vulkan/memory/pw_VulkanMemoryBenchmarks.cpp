@@ -0,0 +1,473 @@
+/*
+  ==============================================================================
+
+   This file is part of the Parawave Vulkan C++ library.
+
+   The code included in this file is provided under the terms of the ISC license
+   https://opensource.org/licenses/ISC.
+
+   Copyright (c) 2021 - Parawave Audio (https://parawave-audio.com/vulkan-cpp-library)
+
+   Permission to use, copy, modify, and/or distribute this software for any 
+   purpose with or without fee is hereby granted, provided that the above 
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES 
+   WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF 
+   MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+   SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES 
+   WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+   OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN 
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+  ==============================================================================
+*/
+
+#if JUCE_UNIT_TESTS
+
+namespace parawave
+{
+
+//==============================================================================
+/** 
+    VulkanMemoryPoolContentionBenchmark
+
+    Threads acquire and dispose small ranges of one concurrent pool. Each run is 
+    timed once with every range going through the pool lock and once with the 
+    thread caches. The pool statistics have to count every range in both modes.
+
+    Run it with a juce::UnitTestRunner, the category is "Benchmarks". Without a 
+    physical device the benchmark is skipped.
+*/
+class VulkanMemoryPoolContentionBenchmark final : public juce::UnitTest
+{
+public:
+    VulkanMemoryPoolContentionBenchmark() : juce::UnitTest("VulkanMemoryPool Contention", "Benchmarks") {}
+
+    void runTest() override
+    {
+        const VulkanInstance instance;
+
+        if (instance.getPhysicalDevices().isEmpty())
+        {
+            logMessage("No physical device, the benchmark is skipped.");
+            return;
+        }
+
+        const VulkanDevice device(*instance.getPhysicalDevices().getFirst());
+
+        for (auto numThreads : { 1, 2, 4, 8 })
+        {
+            beginTest(juce::String(numThreads) + " threads");
+
+            const auto lockedSeconds = run(device, numThreads, false);
+            const auto cachedSeconds = run(device, numThreads, true);
+
+            const auto numRanges = static_cast<double>(numThreads * numIterations * numRangesPerIteration);
+
+            logMessage("Pool lock: " + juce::String(numRanges / lockedSeconds / 1.0e6, 2) + " M ranges/s, "
+                + "thread caches: " + juce::String(numRanges / cachedSeconds / 1.0e6, 2) + " M ranges/s");
+        }
+    }
+
+private:
+    enum
+    {
+        numIterations = 20000,
+        numRangesPerIteration = 16,
+        numSizes = 7 // 256 bytes to 16 KB
+    };
+
+    static constexpr vk::DeviceSize minRangeSize = 256;
+    static constexpr vk::DeviceSize blockSize = 16 * 1024 * 1024;
+
+    struct Worker final : public juce::Thread
+    {
+        Worker(VulkanMemoryPool& pool_, uint32_t memoryTypeIndex_, const juce::WaitableEvent& start_, int seed) :
+            juce::Thread("Memory Pool Benchmark"), pool(pool_), memoryTypeIndex(memoryTypeIndex_), start(start_)
+        {
+            juce::Random random(seed);
+
+            for (auto& size : sizes)
+                size = minRangeSize << random.nextInt(numSizes);
+        }
+
+        void run() override
+        {
+            start.wait();
+
+            VulkanMemoryRange ranges[numRangesPerIteration];
+
+            for (int i = 0; i < numIterations; ++i)
+            {
+                for (int r = 0; r < numRangesPerIteration; ++r)
+                    ranges[r] = pool.acquire(sizes[r], minRangeSize, memoryTypeIndex);
+
+                for (const auto& range : ranges)
+                    pool.dispose(range);
+            }
+        }
+
+        VulkanMemoryPool& pool;
+        const uint32_t memoryTypeIndex;
+        const juce::WaitableEvent& start;
+
+        vk::DeviceSize sizes[numRangesPerIteration];
+    };
+
+    /** The seconds until all threads have finished. */
+    double run(const VulkanDevice& device, int numThreads, bool useThreadCaches)
+    {
+        VulkanMemoryPool pool(device, blockSize);
+        pool.setConcurrent(true, useThreadCaches);
+
+        const auto requirements = vk::MemoryRequirements(minRangeSize << numSizes, minRangeSize, ~0U);
+        const auto memoryTypeIndex = pool.getMemoryTypeIndex(requirements, vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+        // Allocate the block up front, so the benchmark doesn't time vkAllocateMemory
+        pool.reserve(blockSize, memoryTypeIndex);
+
+        juce::WaitableEvent start(true);
+        juce::OwnedArray<Worker> workers;
+
+        for (int i = 0; i < numThreads; ++i)
+            workers.add(new Worker(pool, memoryTypeIndex, start, i))->startThread();
+
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        start.signal();
+
+        for (auto worker : workers)
+            worker->waitForThreadToExit(-1);
+
+        const auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+
+        pool.trimStorage();
+
+        const auto statistics = pool.getStatistics();
+        const auto numRanges = static_cast<juce::uint64>(numThreads * numIterations * numRangesPerIteration);
+
+        expectEquals(statistics.totalAllocations, numRanges, "Every acquired range is counted");
+        expectEquals(statistics.totalFrees, numRanges, "Every disposed range is counted");
+        expectEquals(statistics.total.allocatedBytes, vk::DeviceSize(0), "The thread caches are flushed");
+
+        return seconds;
+    }
+};
+
+static VulkanMemoryPoolContentionBenchmark vulkanMemoryPoolContentionBenchmark;
+
+//==============================================================================
+/** 
+    VulkanRangeAllocatorBenchmark
+
+    Replays the same allocate/free trace on the TLSF allocator of the memory 
+    blocks and on a replica of the first-fit range list it replaced. The trace 
+    keeps a number of ranges alive, with log-uniform sizes like the textures and 
+    buffers of a pool. Doesn't need a device.
+
+    Run it with a juce::UnitTestRunner, the category is "Benchmarks".
+*/
+class VulkanRangeAllocatorBenchmark final : public juce::UnitTest
+{
+public:
+    VulkanRangeAllocatorBenchmark() : juce::UnitTest("VulkanRangeAllocator Trace", "Benchmarks") {}
+
+    void runTest() override
+    {
+        for (auto numLiveRanges : { 64, 512 })
+        {
+            beginTest(juce::String(numLiveRanges) + " live ranges");
+
+            const auto trace = createTrace(numLiveRanges, numOperations, 0x5eed + numLiveRanges);
+
+            const auto firstFit = replay<FirstFitRangeList>(trace);
+            const auto tlsf = replay<TlsfRangeAllocator>(trace);
+
+            logMessage("First-fit: " + firstFit.toString() + ", TLSF: " + tlsf.toString());
+        }
+    }
+
+private:
+    enum
+    {
+        numOperations = 100000,
+        minRangeSizeLog2 = 8,  // 256 bytes
+        maxRangeSizeLog2 = 22  // 4 MB
+    };
+
+    static constexpr vk::DeviceSize blockSize = 256 * 1024 * 1024;
+
+    struct Operation
+    {
+        bool allocate;
+        int id;
+
+        vk::DeviceSize size;
+        vk::DeviceSize alignment;
+    };
+
+    struct Result
+    {
+        juce::String toString() const
+        {
+            return juce::String(seconds * 1.0e9 / numTraceOperations, 1) + " ns/op, " + juce::String(numFailed) + " failed";
+        }
+
+        int numTraceOperations = 0;
+        double seconds = 0.0;
+        int numFailed = 0;
+    };
+
+    /** Allocates until the live ranges reach the target, then allocates and frees at random. */
+    static juce::Array<Operation> createTrace(int numLiveRanges, int numTraceOperations, int seed)
+    {
+        juce::Random random(seed);
+
+        juce::Array<Operation> trace;
+        juce::Array<int> liveIds;
+
+        auto nextId = 0;
+
+        for (int i = 0; i < numTraceOperations; ++i)
+        {
+            if (liveIds.size() < numLiveRanges / 2 || (liveIds.size() < numLiveRanges && random.nextBool()))
+            {
+                const auto sizeLog2 = minRangeSizeLog2 + random.nextFloat() * (maxRangeSizeLog2 - minRangeSizeLog2);
+                const auto size = static_cast<vk::DeviceSize>(std::exp2(sizeLog2));
+                const auto alignment = vk::DeviceSize(256) << random.nextInt(3);
+
+                trace.add(Operation { true, nextId, size, alignment });
+                liveIds.add(nextId++);
+            }
+            else
+            {
+                trace.add(Operation { false, liveIds.removeAndReturn(random.nextInt(liveIds.size())), 0, 0 });
+            }
+        }
+
+        for (auto id : liveIds)
+            trace.add(Operation { false, id, 0, 0 });
+
+        return trace;
+    }
+
+    template <typename AllocatorType>
+    Result replay(const juce::Array<Operation>& trace)
+    {
+        AllocatorType allocator(blockSize);
+
+        juce::HeapBlock<typename AllocatorType::Allocation> allocations(trace.size());
+        juce::HeapBlock<bool> allocated(trace.size(), true);
+
+        Result result;
+        result.numTraceOperations = trace.size();
+
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+
+        for (const auto& operation : trace)
+        {
+            if (operation.allocate)
+            {
+                allocated[operation.id] = allocator.allocate(allocations[operation.id], operation.size, operation.alignment);
+
+                if (! allocated[operation.id])
+                    ++result.numFailed;
+            }
+            else if (allocated[operation.id])
+            {
+                allocator.free(allocations[operation.id]);
+            }
+        }
+
+        result.seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+
+        expect(allocator.isFree(), "All ranges are freed");
+        expectEquals(allocator.getLargestFreeRange(), blockSize, "The free ranges are merged");
+
+        return result;
+    }
+
+    /** The benchmark interface over the allocator of the memory blocks. */
+    struct TlsfRangeAllocator final
+    {
+        using Allocation = VulkanRangeAllocator::Allocation;
+
+        explicit TlsfRangeAllocator(vk::DeviceSize size) : allocator(size) {}
+
+        bool allocate(Allocation& destAllocation, vk::DeviceSize size, vk::DeviceSize alignment)
+        {
+            return allocator.allocate(destAllocation, size, alignment);
+        }
+
+        void free(const Allocation& allocation) noexcept
+        {
+            jassert(allocator.isAllocated(allocation.slot, allocation.generation, allocation.offset));
+            allocator.free(allocation.slot);
+        }
+
+        bool isFree() const noexcept { return allocator.isFree(); }
+
+        vk::DeviceSize getLargestFreeRange() const noexcept { return allocator.getLargestFreeRange(); }
+
+        VulkanRangeAllocator allocator;
+    };
+
+    /** A replica of the range list the memory blocks used before the TLSF allocator. Finds 
+        the first free range that fits, searches a freed range by value and defragments 
+        the whole list after every free. */
+    struct FirstFitRangeList final
+    {
+        struct Allocation
+        {
+            bool operator==(const Allocation& other) const noexcept
+            {
+                return offset == other.offset && size == other.size && free == other.free;
+            }
+
+            vk::DeviceSize getEnd() const noexcept { return offset + size; }
+
+            vk::DeviceSize offset = 0;
+            vk::DeviceSize size = 0;
+
+            bool free = true;
+        };
+
+        explicit FirstFitRangeList(vk::DeviceSize size) : totalSize(size)
+        {
+            ranges.add(Allocation { 0, totalSize, true });
+        }
+
+        bool allocate(Allocation& destAllocation, vk::DeviceSize rangeSize, vk::DeviceSize rangeAlignment)
+        {
+            int index = -1;
+            vk::DeviceSize newSize = 0;
+
+            for (int i = 0; i < ranges.size() && index == -1; ++i)
+            {
+                const auto& range = ranges.getReference(i);
+
+                if (! range.free)
+                    continue;
+
+                newSize = range.size;
+
+                const auto delta = range.offset % rangeAlignment;
+                if (delta != 0)
+                    newSize = newSize > rangeAlignment - delta ? newSize - (rangeAlignment - delta) : 0;
+
+                if (newSize >= rangeSize)
+                    index = i;
+            }
+
+            if (index == -1)
+                return false;
+
+            auto& range = ranges.getReference(index);
+
+            range.size = newSize;
+
+            const auto delta = range.offset % rangeAlignment;
+            if (delta != 0)
+                range.offset += rangeAlignment - delta;
+
+            range.free = false;
+
+            if (range.size == rangeSize)
+            {
+                destAllocation = range;
+                return true;
+            }
+
+            const Allocation remainder { range.offset + rangeSize, range.size - rangeSize, true };
+
+            range.size = rangeSize;
+            destAllocation = range;
+
+            ranges.add(remainder);
+            return true;
+        }
+
+        void free(const Allocation& allocation)
+        {
+            const auto index = ranges.indexOf(allocation);
+            jassert(index >= 0);
+
+            ranges.getReference(index).free = true;
+            defragment();
+        }
+
+        void defragment()
+        {
+            if (isFree())
+            {
+                ranges.clearQuick();
+                ranges.add(Allocation { 0, totalSize, true });
+                return;
+            }
+
+            struct OffsetComparator
+            {
+                static int compareElements(const Allocation& first, const Allocation& second) noexcept
+                {
+                    return first.offset < second.offset ? -1 : (first.offset > second.offset ? 1 : 0);
+                }
+            };
+
+            const OffsetComparator comparator;
+            ranges.sort(comparator);
+
+            for (int i = ranges.size(); --i > 0;)
+            {
+                auto& right = ranges.getReference(i);
+                auto& left = ranges.getReference(i - 1);
+
+                if (! right.free || ! left.free)
+                    continue;
+
+                left.size += right.getEnd() - left.getEnd();
+
+                right.offset = 0;
+                right.size = 0;
+            }
+
+            ranges.removeIf([](const Allocation& range) { return range.size == 0; });
+
+            auto& first = ranges.getReference(0);
+            if (first.free)
+                first.offset = 0;
+
+            auto& last = ranges.getReference(ranges.size() - 1);
+            if (last.free && last.getEnd() < totalSize)
+                last.size = totalSize - last.offset;
+        }
+
+        bool isFree() const noexcept
+        {
+            for (const auto& range : ranges)
+                if (! range.free)
+                    return false;
+
+            return true;
+        }
+
+        vk::DeviceSize getLargestFreeRange() const noexcept
+        {
+            vk::DeviceSize largestFreeRange = 0;
+
+            for (const auto& range : ranges)
+                if (range.free)
+                    largestFreeRange = std::max(largestFreeRange, range.size);
+
+            return largestFreeRange;
+        }
+
+        const vk::DeviceSize totalSize;
+        juce::Array<Allocation> ranges;
+    };
+};
+
+static VulkanRangeAllocatorBenchmark vulkanRangeAllocatorBenchmark;
+
+} // namespace parawave
+
+#endif
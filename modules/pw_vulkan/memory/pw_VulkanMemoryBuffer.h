@@ -31,6 +31,12 @@ namespace parawave
 //==============================================================================
 /** 
     VulkanMemoryBuffer
+
+    A (buffer, offset, size) view of a memory range. If the pool suballocates 
+    buffers with the requested usage, the view points into the buffer of the 
+    memory block. Otherwise the view owns a buffer with offset zero.
+    
+    Always pass getOffset() along with getBuffer() to commands and descriptors!
 */
 class VulkanMemoryBuffer final
 {
@@ -60,42 +66,79 @@ public:
 
         CreateInfo& setTransferSrc() noexcept { bufferUsage |= vk::BufferUsageFlagBits::eTransferSrc; return *this; }
 
+        /** Coherent host memory, that doesn't need flush() or invalidate(). */
         CreateInfo& setHostVisible() noexcept
         {
             memoryProperties |= vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent; return *this;
         }
 
+        /** Host memory the CPU only writes to. Might be non-coherent, write() flushes the written range. */
+        CreateInfo& setHostUpload() noexcept
+        {
+            memoryProperties |= vk::MemoryPropertyFlagBits::eHostVisible; return *this;
+        }
+
+        /** Host cached memory the CPU reads from, if available. Call invalidate() before reading. */
+        CreateInfo& setHostReadback() noexcept
+        {
+            memoryProperties |= vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCached; return *this;
+        }
+
         CreateInfo& setDeviceLocal() noexcept
         {
             memoryProperties |= vk::MemoryPropertyFlagBits::eDeviceLocal; return *this;
         }
 
+        /** The buffer lives long and can't be moved, so its block is never compacted. See VulkanMemoryPool::pin(). */
+        CreateInfo& setPinned() noexcept { pinned = true; return *this; }
+
         vk::DeviceSize bufferSize = {};
         vk::BufferUsageFlags bufferUsage = {};
         vk::MemoryPropertyFlags memoryProperties = {};
+        bool pinned = false;
     };
 
 public:
     VulkanMemoryBuffer(VulkanMemoryPool& pool_, const vk::BufferCreateInfo& bufferCreateInfo, vk::MemoryPropertyFlags memoryProperties) : 
-        pool(pool_), buffer(pool_.getDevice(), bufferCreateInfo), memoryRange(pool_.acquire(buffer.getMemoryRequirements(), memoryProperties))
+        pool(pool_), size(bufferCreateInfo.size)
     {
-        if (auto memoryBlock = memoryRange.getMemoryBlock())
+        if (pool.canSuballocate(bufferCreateInfo.size, bufferCreateInfo.usage))
         {
-            const auto& device = pool.getDevice();
-
-            const auto& deviceMemory = memoryBlock->getDeviceMemory();
-            jassert(deviceMemory.getHandle());
+            memoryRange = pool.acquireSuballocation(size, memoryProperties);
 
-            jassert(memoryRange.getSize() >= buffer.getSize());
+            if (auto memoryBlock = memoryRange.getMemoryBlock())
+            {
+                buffer = memoryBlock->getBuffer();
+                offset = memoryRange.getOffset();
+            }
 
-            jassert(device.getHandle() && buffer.getHandle());
-            auto result = device.getHandle().bindBufferMemory(buffer.getHandle(), deviceMemory.getHandle(), memoryRange.getOffset());
-
-            PW_CHECK_VK_RESULT_SUCCESS(result, "Failed to bind device memory for buffer.");
+            jassert(buffer != nullptr);
         }
         else
         {
-            jassertfalse;
+            ownBuffer = std::make_unique<VulkanBuffer>(pool.getDevice(), bufferCreateInfo);
+            buffer = ownBuffer.get();
+
+            memoryRange = pool.acquire(*ownBuffer, memoryProperties);
+
+            if (auto memoryBlock = memoryRange.getMemoryBlock())
+            {
+                const auto& device = pool.getDevice();
+
+                const auto& deviceMemory = memoryBlock->getDeviceMemory();
+                jassert(deviceMemory.getHandle());
+
+                jassert(memoryRange.getSize() >= ownBuffer->getSize());
+
+                jassert(device.getHandle() && ownBuffer->getHandle());
+                auto result = device.getHandle().bindBufferMemory(ownBuffer->getHandle(), deviceMemory.getHandle(), memoryRange.getOffset());
+
+                PW_CHECK_VK_RESULT_SUCCESS(result, "Failed to bind device memory for buffer.");
+            }
+            else
+            {
+                jassertfalse;
+            }
         }
     }
 
@@ -103,19 +146,39 @@ public:
         VulkanMemoryBuffer(pool_, vk::BufferCreateInfo().setSize(bufferSize).setUsage(bufferUsage).setSharingMode(vk::SharingMode::eExclusive), memoryProperties) {}
 
     VulkanMemoryBuffer(VulkanMemoryPool& pool_, CreateInfo createInfo) :
-        VulkanMemoryBuffer(pool_, createInfo.bufferSize, createInfo.bufferUsage, createInfo.memoryProperties) {}
+        VulkanMemoryBuffer(pool_, createInfo.bufferSize, createInfo.bufferUsage, createInfo.memoryProperties) 
+    {
+        if (createInfo.pinned)
+        {
+            pool.pin(memoryRange);
+            pinned = true;
+        }
+    }
 
     ~VulkanMemoryBuffer()
     {
-        pool.dispose(memoryRange, defragmentFlag);
+        if (pinned)
+            pool.unpin(memoryRange);
+
+        pool.dispose(memoryRange);
     }
 
-    const VulkanBuffer& getBuffer() const noexcept { return buffer; }
+    /** The buffer of the view. Might be shared with other views, see getOffset(). */
+    const VulkanBuffer& getBuffer() const noexcept { return *buffer; }
+
+    /** The offset of the view in the buffer. */
+    vk::DeviceSize getOffset() const noexcept { return offset; }
+
+    /** The requested size of the view. The memory range might be slightly bigger. */
+    vk::DeviceSize getSize() const noexcept { return size; }
+
+    bool isSuballocated() const noexcept { return ownBuffer == nullptr; }
 
     vk::DeviceSize getMemorySize() const noexcept { return memoryRange.getSize(); }
 
-    bool useDefragmentOnRelease() const noexcept { return defragmentFlag; }
-    void setDefragmentOnRelease(bool defragmentOnRelease) noexcept { defragmentFlag = defragmentOnRelease; }
+    const VulkanMemoryRange& getMemoryRange() const noexcept { return memoryRange; }
+
+    VulkanMemoryPool& getMemoryPool() const noexcept { return pool; }
 
     bool isHostVisible() const noexcept { return getData() != nullptr; }
 
@@ -133,18 +196,53 @@ public:
     {
         if (isHostVisible())
         {
-            jassert(dataSrcSize <= memoryRange.getSize());
+            jassert(dataSrcSize <= size);
             std::memcpy(getData(), dataSrc, static_cast<size_t>(dataSrcSize));
+
+            flush(0, dataSrcSize);
         }
     }
 
+    /** Get the mapped range of the view, expanded to whole non-coherent atoms. Use it to flush 
+        or invalidate the ranges of several buffers with a single call. */
+    vk::MappedMemoryRange getMappedRange(vk::DeviceSize rangeOffset = 0, vk::DeviceSize rangeSize = VK_WHOLE_SIZE) const noexcept
+    {
+        jassert(memoryRange.getMemoryBlock() != nullptr);
+        return memoryRange.getMemoryBlock()->getMappedRange(memoryRange.getOffset() + rangeOffset, std::min(rangeSize, size - rangeOffset));
+    }
+
+    bool isHostCoherent() const noexcept
+    {
+        const auto memoryBlock = memoryRange.getMemoryBlock();
+        return memoryBlock == nullptr || memoryBlock->isHostCoherent();
+    }
+
+    /** Make host writes to non-coherent memory visible to the device. */
+    void flush(vk::DeviceSize rangeOffset = 0, vk::DeviceSize rangeSize = VK_WHOLE_SIZE) const noexcept
+    {
+        if (const auto memoryBlock = memoryRange.getMemoryBlock())
+            memoryBlock->flush(memoryRange.getOffset() + rangeOffset, std::min(rangeSize, size - rangeOffset));
+    }
+
+    /** Make device writes to non-coherent memory visible to the host. Call it after the 
+        transfer has completed and before reading from getData(). */
+    void invalidate(vk::DeviceSize rangeOffset = 0, vk::DeviceSize rangeSize = VK_WHOLE_SIZE) const noexcept
+    {
+        if (const auto memoryBlock = memoryRange.getMemoryBlock())
+            memoryBlock->invalidate(memoryRange.getOffset() + rangeOffset, std::min(rangeSize, size - rangeOffset));
+    }
+
 private:
     VulkanMemoryPool& pool;
 
-    const VulkanBuffer buffer;
-    const VulkanMemoryRange memoryRange;
+    std::unique_ptr<VulkanBuffer> ownBuffer;
+    VulkanMemoryRange memoryRange;
+
+    const VulkanBuffer* buffer = nullptr;
+    vk::DeviceSize offset = 0;
+    const vk::DeviceSize size;
 
-    bool defragmentFlag = true;
+    bool pinned = false;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VulkanMemoryBuffer)
 };
@@ -31,6 +31,10 @@ namespace parawave
 //==============================================================================
 /** 
     VulkanMemoryImage
+
+    An image bound to a range of a memory pool. Images that are never used 
+    at the same time can alias the same memory. Those are bound to a range 
+    provided by an Aliasing object, which owns the range instead of the image.
 */
 class VulkanMemoryImage final
 {
@@ -71,35 +75,55 @@ public:
             memoryProperties |= vk::MemoryPropertyFlagBits::eDeviceLocal; return *this;
         }
 
+        /** Rows are stored linearly, so the host can write the pixels directly into the mapped memory. 
+            The image starts in the preinitialized layout. */
+        CreateInfo& setLinearTiling() noexcept { imageTiling = vk::ImageTiling::eLinear; return *this; }
+
+        /** The image lives long and can't be moved, so its block is never compacted. See VulkanMemoryPool::pin(). 
+            An aliased image isn't pinned, the owner of the aliased range pins it instead. */
+        CreateInfo& setPinned() noexcept { pinned = true; return *this; }
+
+        VulkanImage::CreateInfo getImageCreateInfo() const noexcept
+        {
+            auto createInfo = VulkanImage::CreateInfo(width, height, imageFormat, imageUsage);
+
+            if (imageTiling == vk::ImageTiling::eLinear)
+                createInfo.setTiling(vk::ImageTiling::eLinear).setInitialLayout(vk::ImageLayout::ePreinitialized);
+
+            return createInfo;
+        }
+
         uint32_t width = {};
         uint32_t height = {};
         vk::Format imageFormat = {};
         vk::ImageUsageFlags imageUsage = {};
         vk::MemoryPropertyFlags memoryProperties = {};
+        vk::ImageTiling imageTiling = vk::ImageTiling::eOptimal;
+        bool pinned = false;
+    };
+
+    /** Provides the memory of aliased images. */
+    class Aliasing
+    {
+    public:
+        virtual ~Aliasing() = default;
+
+        /** Return a range that fits the memory requirements of the image. The range must 
+            stay valid, as long as the image is used. */
+        virtual VulkanMemoryRange getRangeFor(const VulkanImage& image) = 0;
     };
 
 public:
     VulkanMemoryImage(VulkanMemoryPool& pool_, const vk::ImageCreateInfo& imageCreateInfo, vk::MemoryPropertyFlags memoryProperties) : 
-        pool(pool_), image(pool_.getDevice(), imageCreateInfo), memoryRange(pool_.acquire(image.getMemoryRequirements(), memoryProperties))
+        pool(pool_), image(pool_.getDevice(), imageCreateInfo), memoryRange(pool_.acquire(image, memoryProperties))
     { 
-        if (auto memoryBlock = memoryRange.getMemoryBlock())
-        {
-            const auto& device = pool.getDevice();
-
-            const auto& deviceMemory = memoryBlock->getDeviceMemory();
-            jassert(deviceMemory.getHandle());
-
-            // jassert(memoryRange.getSize() >= buffer.getSize()); TODO: image.getSize() ? 
-
-            jassert(device.getHandle() && image.getHandle());
-            auto result = device.getHandle().bindImageMemory(image.getHandle(), deviceMemory.getHandle(), memoryRange.getOffset());
+        bindMemory();
+    }
 
-            PW_CHECK_VK_RESULT_SUCCESS(result, "Failed to bind device memory for image.");
-        }
-        else
-        {
-            jassertfalse;
-        }
+    VulkanMemoryImage(VulkanMemoryPool& pool_, const vk::ImageCreateInfo& imageCreateInfo, Aliasing& aliasing) : 
+        pool(pool_), image(pool_.getDevice(), imageCreateInfo), memoryRange(aliasing.getRangeFor(image)), ownsMemoryRange(false)
+    { 
+        bindMemory();
     }
 
     VulkanMemoryImage(VulkanMemoryPool& pool, uint32_t width, uint32_t height, 
@@ -107,19 +131,36 @@ public:
         VulkanMemoryImage(pool, VulkanImage::CreateInfo(width, height, imageFormat, imageUsage), memoryProperties) {}
 
     VulkanMemoryImage(VulkanMemoryPool& pool_, CreateInfo createInfo) :
-        VulkanMemoryImage(pool_, createInfo.width, createInfo.height, createInfo.imageFormat, createInfo.imageUsage, createInfo.memoryProperties) {}
+        VulkanMemoryImage(pool_, createInfo.getImageCreateInfo(), createInfo.memoryProperties) 
+    {
+        if (createInfo.pinned)
+        {
+            pool.pin(memoryRange);
+            pinned = true;
+        }
+    }
+
+    VulkanMemoryImage(VulkanMemoryPool& pool_, CreateInfo createInfo, Aliasing& aliasing) :
+        VulkanMemoryImage(pool_, createInfo.getImageCreateInfo(), aliasing) {}
 
     ~VulkanMemoryImage()
     {
-        pool.dispose(memoryRange, defragmentFlag);
+        if (pinned)
+            pool.unpin(memoryRange);
+
+        if (ownsMemoryRange)
+            pool.dispose(memoryRange);
     }
 
     const VulkanImage& getImage() const noexcept { return image; }
 
     vk::DeviceSize getMemorySize() const noexcept { return memoryRange.getSize(); }
 
-    bool useDefragmentOnRelease() const noexcept { return defragmentFlag; }
-    void setDefragmentOnRelease(bool defragmentOnRelease) noexcept { defragmentFlag = defragmentOnRelease; }
+    const VulkanMemoryRange& getMemoryRange() const noexcept { return memoryRange; }
+
+    VulkanMemoryPool& getMemoryPool() const noexcept { return pool; }
+
+    bool isAliased() const noexcept { return ! ownsMemoryRange; }
 
     bool isHostVisible() const noexcept { return getData() != nullptr; }
 
@@ -133,13 +174,50 @@ public:
         return nullptr;
     }
 
+    bool isHostCoherent() const noexcept
+    {
+        const auto memoryBlock = memoryRange.getMemoryBlock();
+        return memoryBlock == nullptr || memoryBlock->isHostCoherent();
+    }
+
+    /** Make host writes to non-coherent memory visible to the device. */
+    void flush(vk::DeviceSize rangeOffset = 0, vk::DeviceSize rangeSize = VK_WHOLE_SIZE) const noexcept
+    {
+        if (const auto memoryBlock = memoryRange.getMemoryBlock())
+            memoryBlock->flush(memoryRange.getOffset() + rangeOffset, std::min(rangeSize, memoryRange.getSize() - rangeOffset));
+    }
+
+private:
+    void bindMemory()
+    {
+        if (auto memoryBlock = memoryRange.getMemoryBlock())
+        {
+            const auto& device = pool.getDevice();
+
+            const auto& deviceMemory = memoryBlock->getDeviceMemory();
+            jassert(deviceMemory.getHandle());
+
+            // jassert(memoryRange.getSize() >= buffer.getSize()); TODO: image.getSize() ? 
+
+            jassert(device.getHandle() && image.getHandle());
+            auto result = device.getHandle().bindImageMemory(image.getHandle(), deviceMemory.getHandle(), memoryRange.getOffset());
+
+            PW_CHECK_VK_RESULT_SUCCESS(result, "Failed to bind device memory for image.");
+        }
+        else
+        {
+            jassertfalse;
+        }
+    }
+
 private:
     VulkanMemoryPool& pool;
 
     const VulkanImage image;
     const VulkanMemoryRange memoryRange;
 
-    bool defragmentFlag = true;
+    const bool ownsMemoryRange = true;
+    bool pinned = false;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VulkanMemoryImage)
 };
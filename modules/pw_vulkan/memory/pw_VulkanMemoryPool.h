@@ -33,21 +33,130 @@ namespace parawave
     VulkanMemoryPool 
 
     A pool of DeviceMemory allocations. 
+
+    Buffers and images that are bigger than the dedicated allocation threshold,
+    or that the driver prefers to be dedicated (VK_KHR_dedicated_allocation),
+    get their own exactly sized DeviceMemory instead of a shared block. 
+    By default the threshold equals the minimum block size.
+
+    Long sessions can leave big blocks pinned by a few small ranges. The pool 
+    can compact one block at a time: beginCompaction() selects the sparsest 
+    block, which won't receive any new ranges. Transient ranges drain out of it 
+    by themselves, long living resources have to be moved by their owner, see 
+    isEvacuating(). Once empty, updateCompaction() releases the block. 
+    Long living resources that can't be moved are pinned, see pin(), and their 
+    blocks are never selected.
+
+    With buffer suballocation, small buffers don't create their own VkBuffer. 
+    Each block owns a single buffer with the union of the suballocation usage 
+    flags and VulkanMemoryBuffer becomes a view at the offset of its range.
+
+    By default the pool is only safe to use on one thread. In concurrent mode 
+    all blocks are guarded by a lock, and every thread keeps a small cache of 
+    the ranges it disposed, so it can acquire them again without the lock.
+    The caches are found through thread local storage and are only shared with 
+    the pool while it flushes them. Ranges in the thread caches still count as 
+    allocated, until trimStorage() returns them to their blocks.
+
+    To keep vkAllocateMemory out of steady frames, the pool tracks the rolling 
+    high-water mark of its allocated bytes. trimStorage() only releases empty 
+    blocks above the high-water mark plus headroom, and when the pool has to 
+    grow below the high-water mark, it grows back in one step. reserve() 
+    preallocates blocks up front and keeps their total size as a lower bound.
+
+    Pools of many small resources of a few common sizes can serve them from 
+    slabs. A slab is a run of equally sized, aligned slots in one range of a 
+    block, with a bitmap of the free slots. Acquiring and disposing a slot is 
+    O(1) and a disposed slot leaves no fragment behind.
+
+    The memory type of a request is ranked by the intent of the pool, see 
+    VulkanMemoryUsage. If the heap of the best memory type is exhausted, the 
+    request falls back to the next type in the ranking.
 */
 class VulkanMemoryPool final
 {
 public:
-    VulkanMemoryPool(const VulkanDevice& device_, vk::DeviceSize minBlockSize_) : 
-        device(device_), minBlockSize(minBlockSize_) {}
+    struct Statistics final
+    {
+        juce::var toVar() const
+        {
+            auto object = new juce::DynamicObject();
+
+            object->setProperty("total", total.toVar());
+
+            juce::Array<juce::var> memoryTypeObjects;
+            for (const auto& memoryType : memoryTypes)
+                memoryTypeObjects.add(memoryType.toVar());
+
+            object->setProperty("memoryTypes", memoryTypeObjects);
+            object->setProperty("peakAllocatedBytes", static_cast<juce::int64>(peakAllocatedBytes));
+            object->setProperty("peakBlockBytes", static_cast<juce::int64>(peakBlockBytes));
+            object->setProperty("totalAllocations", static_cast<juce::int64>(totalAllocations));
+            object->setProperty("totalFrees", static_cast<juce::int64>(totalFrees));
+            object->setProperty("allocationsPerSecond", allocationsPerSecond);
+            object->setProperty("freesPerSecond", freesPerSecond);
+
+            return juce::var(object);
+        }
+
+        /** The sum of all blocks and the blocks of each used memory type. */
+        VulkanMemoryStatistics total;
+        juce::Array<VulkanMemoryStatistics> memoryTypes;
+
+        vk::DeviceSize peakAllocatedBytes = 0;
+        vk::DeviceSize peakBlockBytes = 0;
+
+        juce::uint64 totalAllocations = 0;
+        juce::uint64 totalFrees = 0;
+
+        /** Averaged over the last completed window of at least one second. */
+        double allocationsPerSecond = 0.0;
+        double freesPerSecond = 0.0;
+    };
+
+public:
+    VulkanMemoryPool(const VulkanDevice& device_, vk::DeviceSize minBlockSize_, vk::BufferUsageFlags suballocationUsage_ = {}) : 
+        device(device_), minBlockSize(minBlockSize_), dedicatedAllocationThreshold(minBlockSize_) 
+    {
+        setBufferSuballocation(suballocationUsage_);
+    }
 
     const VulkanDevice& getDevice() const noexcept { return device; }
 
+    vk::DeviceSize getDedicatedAllocationThreshold() const noexcept { return dedicatedAllocationThreshold; }
+
+    void setDedicatedAllocationThreshold(vk::DeviceSize newThreshold) noexcept { dedicatedAllocationThreshold = newThreshold; }
+
+    VulkanMemoryUsage::Intent getMemoryIntent() const noexcept { return memoryIntent; }
+
+    /** Set how the resources of the pool are used, before any memory is acquired. */
+    void setMemoryIntent(VulkanMemoryUsage::Intent newIntent) noexcept { memoryIntent = newIntent; }
+
+    /** Enable the concurrent mode before the pool is shared with other threads. Without the 
+        thread caches, every range is acquired and disposed with the pool lock. */
+    void setConcurrent(bool shouldBeConcurrent, bool shouldUseThreadCaches = true)
+    {
+        if (! shouldBeConcurrent || ! shouldUseThreadCaches)
+        {
+            const ScopedPoolLock sl(*this);
+            flushThreadCaches();
+        }
+
+        concurrent = shouldBeConcurrent;
+        useThreadCaches = shouldUseThreadCaches;
+    }
+
+    bool isConcurrent() const noexcept { return concurrent; }
+
     vk::DeviceSize size() const noexcept 
     { 
+        const ScopedPoolLock sl(*this);
+
         vk::DeviceSize totalSize = 0;
 
         for (auto& block : blocks)
-            totalSize += block->size();
+            if (block != nullptr)
+                totalSize += block->size();
 
         return totalSize; 
     }
@@ -56,91 +165,1141 @@ public:
     {
         VulkanMemoryRange range;
 
-        for (auto& block : blocks)
-        {
-            if (memoryTypeIndex == block->getMemoryTypeIndex())
-                if (block->acquireRange(range, requiredSize, requiredAlignment))
-                    return range;
-        }
+        if (concurrent && useThreadCaches && acquireFromThreadCache(range, requiredSize, requiredAlignment, memoryTypeIndex))
+            return range;
 
-        auto newBlock = blocks.add(allocateBlock(requiredSize, memoryTypeIndex).release());
+        const ScopedPoolLock sl(*this);
 
-        const auto acquired = newBlock->acquireRange(range, requiredSize, requiredAlignment);
-        jassert(acquired);
-        
-        return range;
+        if (acquireFromSlab(range, requiredSize, requiredAlignment, memoryTypeIndex))
+            return countAllocation(range);
+
+        if (acquireFromBlocks(range, requiredSize, requiredAlignment, memoryTypeIndex))
+            return countAllocation(range);
+
+        // Grow back to the recent high-water mark in one step, instead of one block per frame
+        const auto blockBytes = size();
+        const auto shortfall = highWaterMark() > blockBytes ? highWaterMark() - blockBytes : vk::DeviceSize(0);
+        const auto growthSize = std::max(requiredSize, std::min(shortfall, maxGrowthBlocks * minBlockSize));
+
+        return acquireFromNewBlock(allocateBlock(growthSize, memoryTypeIndex), requiredSize, requiredAlignment);
     }
     
     VulkanMemoryRange acquire(const vk::MemoryRequirements& memoryRequirements, vk::MemoryPropertyFlags memoryProperties)
     {
-        const auto memoryTypeIndex = findMemoryType(memoryRequirements.memoryTypeBits, memoryProperties);
+        const auto memoryTypeIndex = findMemoryType(memoryRequirements.memoryTypeBits, memoryProperties, std::max(memoryRequirements.size, minBlockSize));
         return acquire(memoryRequirements.size, memoryRequirements.alignment, memoryTypeIndex);
     }
 
-    void dispose(const VulkanMemoryRange& range, bool performDefragmentation = true)
+    VulkanMemoryRange acquire(const VulkanBuffer& buffer, vk::MemoryPropertyFlags memoryProperties)
     {
-        for (auto block : blocks)
+        if (! device.supportsDedicatedAllocation())
+            return acquireResource(buffer.getMemoryRequirements(), false, nullptr, memoryProperties);
+
+        const auto requirements = device.getHandle().getBufferMemoryRequirements2KHR<vk::MemoryRequirements2, vk::MemoryDedicatedRequirements>
+        (
+            vk::BufferMemoryRequirementsInfo2(buffer.getHandle())
+        );
+
+        const auto& dedicatedRequirements = requirements.get<vk::MemoryDedicatedRequirements>();
+        const auto dedicatedInfo = vk::MemoryDedicatedAllocateInfo().setBuffer(buffer.getHandle());
+
+        return acquireResource(requirements.get<vk::MemoryRequirements2>().memoryRequirements, 
+            dedicatedRequirements.prefersDedicatedAllocation || dedicatedRequirements.requiresDedicatedAllocation, &dedicatedInfo, memoryProperties);
+    }
+
+    VulkanMemoryRange acquire(const VulkanImage& image, vk::MemoryPropertyFlags memoryProperties)
+    {
+        if (! device.supportsDedicatedAllocation())
+            return acquireResource(image.getMemoryRequirements(), false, nullptr, memoryProperties);
+
+        const auto requirements = device.getHandle().getImageMemoryRequirements2KHR<vk::MemoryRequirements2, vk::MemoryDedicatedRequirements>
+        (
+            vk::ImageMemoryRequirementsInfo2(image.getHandle())
+        );
+
+        const auto& dedicatedRequirements = requirements.get<vk::MemoryDedicatedRequirements>();
+        const auto dedicatedInfo = vk::MemoryDedicatedAllocateInfo().setImage(image.getHandle());
+
+        return acquireResource(requirements.get<vk::MemoryRequirements2>().memoryRequirements, 
+            dedicatedRequirements.prefersDedicatedAllocation || dedicatedRequirements.requiresDedicatedAllocation, &dedicatedInfo, memoryProperties);
+    }
+
+    /** The memory type the pool would use for the requirements. */
+    uint32_t getMemoryTypeIndex(const vk::MemoryRequirements& memoryRequirements, vk::MemoryPropertyFlags memoryProperties) const
+    {
+        return findMemoryType(memoryRequirements.memoryTypeBits, memoryProperties, std::max(memoryRequirements.size, minBlockSize));
+    }
+
+    void dispose(const VulkanMemoryRange& range)
+    {
+        if (concurrent && useThreadCaches && releaseToThreadCache(range))
+            return;
+
+        const ScopedPoolLock sl(*this);
+        disposeRange(range);
+    }
+
+    /** Release all empty blocks, including the reserved ones. */
+    void minimizeStorage()
+    {
+        const ScopedPoolLock sl(*this);
+
+        flushThreadCaches();
+        deallocateEmptyBlocks();
+    }
+
+    /** Release empty blocks, as long as the total size of the remaining blocks still covers the 
+        reserved bytes and the rolling high-water mark plus the headroom ratio. The ranges in the 
+        thread caches return to their blocks first, and the caches of threads that exited are 
+        removed. */
+    void trimStorage(float headroom = 0.5f)
+    {
+        const ScopedPoolLock sl(*this);
+
+        flushThreadCaches();
+        pruneThreadCaches();
+
+        updateHighWaterMark();
+
+        const auto peak = static_cast<double>(highWaterMark()) * (1.0 + static_cast<double>(headroom));
+        const auto keepBytes = std::max(reservedBytes, static_cast<vk::DeviceSize>(peak));
+
+        auto blockBytes = size();
+
+        for (int i = blocks.size(); --i >= 0;)
         {
-            if (block->contains(range))
+            const auto block = blocks.getUnchecked(i);
+
+            if (block != nullptr && block->isFree() && blockBytes - block->size() >= keepBytes)
             {
-                block->disposeRange(range, performDefragmentation);
+                blockBytes -= block->size();
+                blocks.set(i, nullptr, true);
 
-                return;
+                if (i == compactionBlock)
+                    compactionBlock = -1;
             }
         }
 
-        // Range was not acquired by this allocator or is already disposed
-        jassertfalse;
+        removeTrailingSlots();
     }
 
-    void minimizeStorage()
+    /** Preallocate blocks of the memory type, until the blocks of the pool hold at least the 
+        requested bytes in total, allocated or not. trimStorage() keeps that many bytes in blocks, 
+        only minimizeStorage() releases them. */
+    void reserve(vk::DeviceSize bytes, uint32_t memoryTypeIndex)
     {
-        deallocateEmptyBlocks();
+        const ScopedPoolLock sl(*this);
+
+        reservedBytes = std::max(reservedBytes, bytes);
+
+        for (auto blockBytes = size(); blockBytes < bytes; blockBytes = size())
+            addBlock(allocateBlock(bytes - blockBytes, memoryTypeIndex));
+    }
+
+    void reserve(vk::DeviceSize bytes, const vk::MemoryRequirements& memoryRequirements, vk::MemoryPropertyFlags memoryProperties)
+    {
+        reserve(bytes, findMemoryType(memoryRequirements.memoryTypeBits, memoryProperties, bytes));
+    }
+
+    vk::DeviceSize getReservedBytes() const noexcept { return reservedBytes; }
+
+    /** The peak of the allocated bytes in the current and the previous window. */
+    vk::DeviceSize getHighWaterMark() const noexcept 
+    {
+        const ScopedPoolLock sl(*this);
+        return highWaterMark();
+    }
+
+    //==============================================================================
+    /** Serve ranges up to the biggest slot size from slabs. The slot sizes must be powers of two. 
+        A range uses the smallest slot that fits its size and alignment. Pass an empty array to 
+        disable the slabs, existing slabs are released once their slots are disposed. */
+    void setSlabSlotSizes(juce::Array<vk::DeviceSize> slotSizes)
+    {
+        const ScopedPoolLock sl(*this);
+
+        slotSizes.sort();
+        slabClasses.clearQuick();
+
+        for (const auto slotSize : slotSizes)
+        {
+            jassert(slotSize > 0 && (slotSize & (slotSize - 1)) == 0);
+
+            SlabClass slabClass;
+            slabClass.slotSize = slotSize;
+
+            for (int i = 0; i < slabs.size(); ++i)
+                if (auto slab = slabs.getUnchecked(i))
+                    if (slab->slotSize == slotSize && ! slab->isFull())
+                        slabClass.availableSlabs.add(i);
+
+            slabClasses.add(slabClass);
+        }
+    }
+
+    //==============================================================================
+    /** Let buffers with a subset of the usage flags share the buffer of their block. 
+        Pass empty flags to create one buffer per allocation again. */
+    void setBufferSuballocation(vk::BufferUsageFlags usage)
+    {
+        suballocationUsage = usage;
+
+        if (usage)
+        {
+            // The supported memory types only depend on the usage, not on the size of a buffer
+            const VulkanBuffer probeBuffer(device, 1, usage);
+            suballocationRequirements = probeBuffer.getMemoryRequirements();
+
+            suballocationRequirements.alignment = std::max(suballocationRequirements.alignment, getOffsetAlignment(usage));
+        }
+    }
+
+    vk::BufferUsageFlags getBufferSuballocation() const noexcept { return suballocationUsage; }
+
+    /** Only buffers below the dedicated allocation threshold are suballocated. */
+    bool canSuballocate(vk::DeviceSize bufferSize, vk::BufferUsageFlags usage) const noexcept
+    {
+        return suballocationUsage && (usage & suballocationUsage) == usage && bufferSize < dedicatedAllocationThreshold;
+    }
+
+    /** Acquire a range in a block that owns a buffer with the suballocation usage flags. */
+    VulkanMemoryRange acquireSuballocation(vk::DeviceSize requiredSize, vk::MemoryPropertyFlags memoryProperties)
+    {
+        jassert(suballocationUsage);
+
+        auto memoryRequirements = suballocationRequirements;
+        memoryRequirements.size = requiredSize;
+
+        auto range = acquire(memoryRequirements, memoryProperties);
+
+        const ScopedPoolLock sl(*this);
+
+        if (auto block = blocks[range.getHandle().block])
+            block->getOrCreateBuffer(suballocationUsage);
+
+        return range;
+    }
+
+    //==============================================================================
+    Statistics getStatistics() const
+    {
+        const ScopedPoolLock sl(*this);
+
+        Statistics statistics;
+
+        for (auto block : blocks)
+        {
+            if (block == nullptr)
+                continue;
+
+            const auto blockStatistics = block->getStatistics();
+            statistics.total += blockStatistics;
+
+            auto memoryType = std::find_if(statistics.memoryTypes.begin(), statistics.memoryTypes.end(), 
+                [&](const VulkanMemoryStatistics& other) { return other.memoryTypeIndex == blockStatistics.memoryTypeIndex; });
+
+            if (memoryType != statistics.memoryTypes.end())
+                *memoryType += blockStatistics;
+            else
+                statistics.memoryTypes.add(blockStatistics);
+        }
+
+        updateRates();
+
+        statistics.peakAllocatedBytes = peakAllocatedBytes;
+        statistics.peakBlockBytes = peakBlockBytes;
+        statistics.totalAllocations = getTotalAllocations();
+        statistics.totalFrees = getTotalFrees();
+        statistics.allocationsPerSecond = allocationsPerSecond;
+        statistics.freesPerSecond = freesPerSecond;
+
+        return statistics;
+    }
+
+    //==============================================================================
+    /** Select the block with the least allocated memory for compaction. A block only qualifies 
+        if its usage is below the ratio and the other blocks of the same memory type have enough 
+        free space to take all of its ranges. Returns false if no block qualifies. */
+    bool beginCompaction(float maxUsageRatio = 0.25f)
+    {
+        const ScopedPoolLock sl(*this);
+
+        if (isCompacting())
+            return true;
+
+        // Cached ranges and empty slabs would pin the blocks
+        flushThreadCaches();
+        releaseEmptySlabs();
+
+        for (int i = 0; i < blocks.size(); ++i)
+        {
+            const auto block = blocks.getUnchecked(i);
+
+            if (block == nullptr || block->isDedicated() || block->isFree() || block->hasPinnedRanges() || hasCompactionTimedOut(i))
+                continue;
+
+            const auto usageRatio = static_cast<float>(block->getAllocatedSize()) / static_cast<float>(block->size());
+            
+            if (usageRatio > maxUsageRatio || getFreeSize(block->getMemoryTypeIndex(), i) < block->getAllocatedSize())
+                continue;
+
+            if (compactionBlock < 0 || block->getAllocatedSize() < blocks.getUnchecked(compactionBlock)->getAllocatedSize())
+                compactionBlock = i;
+        }
+
+        if (isCompacting())
+            compactionStart = juce::Time::getCurrentTime();
+
+        return isCompacting();
+    }
+
+    bool isCompacting() const noexcept { return compactionBlock >= 0; }
+
+    /** Mark a range whose owner can't move it, e.g. a buffer that lives as long as the pool. 
+        The block of a pinned range is never compacted. Unpin the range before it's disposed. */
+    void pin(const VulkanMemoryRange& range)
+    {
+        const ScopedPoolLock sl(*this);
+
+        if (auto block = blocks[range.getHandle().block])
+        {
+            block->pinRange();
+
+            if (range.getHandle().block == compactionBlock)
+                compactionBlock = -1;
+        }
+    }
+
+    void unpin(const VulkanMemoryRange& range)
+    {
+        const ScopedPoolLock sl(*this);
+
+        if (auto block = blocks[range.getHandle().block])
+            block->unpinRange();
+    }
+
+    /** True if the range lies in the block that is compacted and should be moved by its owner. */
+    bool isEvacuating(const VulkanMemoryRange& range) const noexcept
+    {
+        return isCompacting() && range.getHandle().block == compactionBlock;
+    }
+
+    /** Release the compacted block as soon as all ranges have left it. If that takes longer than the 
+        timeout, the block is probably held by a resource that can't be moved and will receive ranges 
+        again. It isn't selected again, until some of its ranges were disposed. Returns true if the 
+        compaction has finished. */
+    bool updateCompaction(juce::RelativeTime timeout = juce::RelativeTime::seconds(10.0))
+    {
+        const ScopedPoolLock sl(*this);
+
+        if (! isCompacting())
+            return true;
+
+        if (blocks[compactionBlock]->isFree())
+        {
+            blocks.set(compactionBlock, nullptr, true);
+            removeTrailingSlots();
+
+            compactionBlock = -1;
+        }
+        else if (juce::Time::getCurrentTime() - compactionStart > timeout)
+        {
+            removeCompactionTimeout(compactionBlock);
+            compactionTimeouts.add(CompactionTimeout { compactionBlock, blocks[compactionBlock]->getAllocatedSize() });
+            compactionBlock = -1;
+        }
+
+        return ! isCompacting();
     }
 
 private:
+    /** Only locks the pool in concurrent mode. The lock is reentrant, so the public 
+        methods can call each other. */
+    struct ScopedPoolLock final
+    {
+        explicit ScopedPoolLock(const VulkanMemoryPool& pool) noexcept : 
+            lock(pool.concurrent ? &pool.lock : nullptr)
+        {
+            if (lock != nullptr)
+                lock->enter();
+        }
+
+        ~ScopedPoolLock()
+        {
+            if (lock != nullptr)
+                lock->exit();
+        }
+
+        const juce::CriticalSection* lock;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedPoolLock)
+    };
+
+    /** Ranges disposed by a thread, sorted by the power of two of their size. Only the 
+        owning thread uses the cache, the spin lock is only contended while the pool 
+        flushes the caches or sums up their counters. */
+    struct ThreadCache final : public juce::ReferenceCountedObject
+    {
+        using Ptr = juce::ReferenceCountedObjectPtr<ThreadCache>;
+
+        enum
+        {
+            maxRangeSizeLog2 = 16, // 64 KB
+            numSizeClasses = maxRangeSizeLog2 + 1,
+            maxNumRangesPerClass = 8
+        };
+
+        static int getSizeClass(vk::DeviceSize rangeSize) noexcept
+        {
+            auto sizeClass = 0;
+
+            while ((rangeSize >>= 1) != 0)
+                ++sizeClass;
+
+            return sizeClass;
+        }
+
+        juce::SpinLock lock;
+        juce::Array<VulkanMemoryRange> ranges[numSizeClasses];
+
+        // The cache hits, counted like the allocations and frees of the pool
+        juce::uint64 numAllocations = 0;
+        juce::uint64 numFrees = 0;
+
+        // Set when the owning thread exits, pruneThreadCaches() removes the cache
+        std::atomic<bool> abandoned { false };
+    };
+
+    /** The caches of the calling thread, one for each concurrent pool it used. The pools are 
+        identified by a unique id, since a deleted pool can leave its address to a new one. */
+    struct ThreadCacheSlots final
+    {
+        struct Slot
+        {
+            juce::uint64 poolId;
+            ThreadCache::Ptr cache;
+        };
+
+        ~ThreadCacheSlots()
+        {
+            for (const auto& slot : slots)
+                slot.cache->abandoned = true;
+        }
+
+        juce::Array<Slot> slots;
+    };
+
+    static juce::Array<ThreadCacheSlots::Slot>& getThreadCacheSlots() noexcept
+    {
+        static thread_local ThreadCacheSlots threadCacheSlots;
+        return threadCacheSlots.slots;
+    }
+
+    static juce::uint64 createPoolId() noexcept
+    {
+        static std::atomic<juce::uint64> lastPoolId { 0 };
+        return ++lastPoolId;
+    }
+
+    /** The cache of the calling thread. Only its first use on a thread locks the pool, to 
+        register the new cache for flushing. */
+    ThreadCache& getThreadCache()
+    {
+        auto& slots = getThreadCacheSlots();
+
+        for (const auto& slot : slots)
+            if (slot.poolId == poolId)
+                return *slot.cache;
+
+        // A cache that is only referenced by its thread belonged to a deleted pool
+        slots.removeIf([](const ThreadCacheSlots::Slot& slot) { return slot.cache->getReferenceCount() == 1; });
+
+        ThreadCache::Ptr threadCache = new ThreadCache();
+
+        {
+            const ScopedPoolLock sl(*this);
+            threadCaches.add(threadCache);
+        }
+
+        slots.add(ThreadCacheSlots::Slot { poolId, threadCache });
+        return *threadCache;
+    }
+
+    /** Call the function with the locked cache of the calling thread, which is created on first use. */
+    template <typename Function>
+    bool useThreadCache(Function&& function)
+    {
+        auto& threadCache = getThreadCache();
+
+        const juce::SpinLock::ScopedLockType sl(threadCache.lock);
+        return function(threadCache);
+    }
+
+    /** Reuse a range of the same or the next size class, that was disposed by this thread. */
+    bool acquireFromThreadCache(VulkanMemoryRange& destRange, vk::DeviceSize requiredSize, vk::DeviceSize requiredAlignment, uint32_t memoryTypeIndex)
+    {
+        const auto sizeClass = ThreadCache::getSizeClass(requiredSize);
+        if (sizeClass >= ThreadCache::numSizeClasses)
+            return false;
+
+        const auto lastSizeClass = std::min(sizeClass + 1, static_cast<int>(ThreadCache::numSizeClasses) - 1);
+
+        return useThreadCache([&](ThreadCache& threadCache)
+        {
+            for (auto c = sizeClass; c <= lastSizeClass; ++c)
+            {
+                auto& ranges = threadCache.ranges[c];
+
+                for (int i = ranges.size(); --i >= 0;)
+                {
+                    const auto& range = ranges.getReference(i);
+
+                    if (range.getSize() >= requiredSize && range.getOffset() % std::max(requiredAlignment, vk::DeviceSize(1)) == 0
+                        && range.getMemoryBlock()->getMemoryTypeIndex() == memoryTypeIndex && !isEvacuating(range))
+                    {
+                        destRange = ranges.removeAndReturn(i);
+                        ++threadCache.numAllocations;
+                        return true;
+                    }
+                }
+            }
+
+            return false;
+        });
+    }
+
+    /** Keep a small range in the cache of this thread, instead of returning it to its block. */
+    bool releaseToThreadCache(const VulkanMemoryRange& range)
+    {
+        const auto sizeClass = ThreadCache::getSizeClass(range.getSize());
+
+        // The block of a live range can't be deallocated, so it's safe to access without the lock
+        const auto block = range.getMemoryBlock();
+
+        if (sizeClass >= ThreadCache::numSizeClasses || block == nullptr || block->isDedicated() || isEvacuating(range))
+            return false;
+
+        return useThreadCache([&](ThreadCache& threadCache)
+        {
+            auto& ranges = threadCache.ranges[sizeClass];
+            if (ranges.size() >= ThreadCache::maxNumRangesPerClass)
+                return false;
+
+            ranges.add(range);
+            ++threadCache.numFrees;
+            return true;
+        });
+    }
+
+    /** Return the cached ranges of all threads to their blocks. Must be called with the pool lock. */
+    void flushThreadCaches()
+    {
+        juce::Array<VulkanMemoryRange> flushedRanges;
+
+        for (auto threadCache : threadCaches)
+        {
+            const juce::SpinLock::ScopedLockType sl(threadCache->lock);
+
+            for (auto& ranges : threadCache->ranges)
+            {
+                flushedRanges.addArray(ranges);
+                ranges.clearQuick();
+            }
+        }
+
+        // Disposed without the spin locks, since counting the frees sums up the cache counters
+        for (const auto& range : flushedRanges)
+            disposeRange(range);
+    }
+
+    /** Remove the caches of the threads that exited. Their counters are kept by the pool. 
+        Must be called after flushThreadCaches(). */
+    void pruneThreadCaches()
+    {
+        for (int i = threadCaches.size(); --i >= 0;)
+        {
+            auto threadCache = threadCaches.getObjectPointerUnchecked(i);
+
+            if (threadCache->abandoned)
+            {
+                totalAllocations += threadCache->numAllocations;
+                totalFrees += threadCache->numFrees;
+
+                threadCaches.remove(i);
+            }
+        }
+    }
+
+    /** Including the cache hits of all threads. Must be called with the pool lock. */
+    juce::uint64 getTotalAllocations() const noexcept
+    {
+        auto numAllocations = totalAllocations;
+
+        for (auto threadCache : threadCaches)
+        {
+            const juce::SpinLock::ScopedLockType sl(threadCache->lock);
+            numAllocations += threadCache->numAllocations;
+        }
+
+        return numAllocations;
+    }
+
+    /** Including the cache hits of all threads. Must be called with the pool lock. */
+    juce::uint64 getTotalFrees() const noexcept
+    {
+        auto numFrees = totalFrees;
+
+        for (auto threadCache : threadCaches)
+        {
+            const juce::SpinLock::ScopedLockType sl(threadCache->lock);
+            numFrees += threadCache->numFrees;
+        }
+
+        return numFrees;
+    }
+
+    void disposeRange(const VulkanMemoryRange& range)
+    {
+        if (range.getHandle().slab >= 0)
+        {
+            disposeSlabRange(range);
+            return;
+        }
+
+        const auto block = blocks[range.getHandle().block];
+
+        // Range was not acquired by this allocator or is already disposed
+        if (block == nullptr || block != range.getMemoryBlock())
+        {
+            jassertfalse;
+            return;
+        }
+
+        block->disposeRange(range);
+        countFree(range);
+
+        // Dedicated memory is never reused for other resources
+        if (block->isDedicated())
+        {
+            blocks.set(range.getHandle().block, nullptr, true);
+            removeTrailingSlots();
+        }
+    }
+
     static vk::DeviceSize nextPowerOfTwo(vk::DeviceSize size) noexcept
     {
         const auto power = static_cast<vk::DeviceSize>(std::log2l(static_cast<long double>(size))) + 1;
         return static_cast<vk::DeviceSize>(1) << power;
     }
 
+    /** Acquire the memory of a buffer or image. The dedicated info is only chained if the extension is supported. */
+    VulkanMemoryRange acquireResource(const vk::MemoryRequirements& memoryRequirements, bool prefersDedicatedAllocation,
+        const vk::MemoryDedicatedAllocateInfo* dedicatedInfo, vk::MemoryPropertyFlags memoryProperties)
+    {
+        const ScopedPoolLock sl(*this);
+
+        if (! prefersDedicatedAllocation && memoryRequirements.size < dedicatedAllocationThreshold)
+            return acquire(memoryRequirements, memoryProperties);
+
+        const auto memoryTypeIndex = findMemoryType(memoryRequirements.memoryTypeBits, memoryProperties, memoryRequirements.size);
+
+        const auto allocateInfo = vk::MemoryAllocateInfo(memoryRequirements.size, memoryTypeIndex).setPNext(dedicatedInfo);
+        auto dedicatedBlock = std::make_unique<VulkanMemory>(device, allocateInfo, true);
+
+        return acquireFromNewBlock(std::move(dedicatedBlock), memoryRequirements.size, memoryRequirements.alignment);
+    }
+
+    bool acquireFromBlocks(VulkanMemoryRange& destRange, vk::DeviceSize requiredSize, vk::DeviceSize requiredAlignment, uint32_t memoryTypeIndex)
+    {
+        for (int i = 0; i < blocks.size(); ++i)
+        {
+            auto block = blocks.getUnchecked(i);
+
+            if (i == compactionBlock)
+                continue;
+
+            if (block != nullptr && !block->isDedicated() && memoryTypeIndex == block->getMemoryTypeIndex())
+            {
+                if (block->acquireRange(destRange, requiredSize, requiredAlignment))
+                {
+                    destRange.handle.block = i;
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    //==============================================================================
+    /** A run of equally sized slots in one range of a block. */
+    struct Slab final
+    {
+        enum { maxNumSlots = 64 };
+
+        bool isFull() const noexcept { return freeSlots == 0; }
+
+        bool isEmpty() const noexcept { return freeSlots == getAllSlots(); }
+
+        uint64_t getAllSlots() const noexcept 
+        { 
+            return numSlots == maxNumSlots ? ~uint64_t(0) : (uint64_t(1) << numSlots) - 1; 
+        }
+
+        VulkanMemoryRange range;
+        vk::DeviceSize slotSize = 0;
+
+        int numSlots = 0;
+        uint64_t freeSlots = 0;
+
+        // The generation of the last allocation of each slot, see VulkanMemoryRange::Handle
+        uint32_t slotGenerations[maxNumSlots] = {};
+    };
+
+    /** The slabs of one slot size, that still have free slots. */
+    struct SlabClass final
+    {
+        vk::DeviceSize slotSize = 0;
+        juce::Array<int> availableSlabs;
+    };
+
+    SlabClass* findSlabClass(vk::DeviceSize slotSize) noexcept
+    {
+        for (auto& slabClass : slabClasses)
+            if (slabClass.slotSize == slotSize)
+                return &slabClass;
+
+        return nullptr;
+    }
+
+    bool acquireFromSlab(VulkanMemoryRange& destRange, vk::DeviceSize requiredSize, vk::DeviceSize requiredAlignment, uint32_t memoryTypeIndex)
+    {
+        requiredAlignment = std::max(requiredAlignment, vk::DeviceSize(1));
+
+        auto slabClass = std::find_if(slabClasses.begin(), slabClasses.end(), [&](const SlabClass& c)
+        {
+            return c.slotSize >= requiredSize && c.slotSize % requiredAlignment == 0;
+        });
+
+        if (slabClass == slabClasses.end())
+            return false;
+
+        auto slabIndex = -1;
+
+        for (int i = slabClass->availableSlabs.size(); --i >= 0;)
+        {
+            const auto index = slabClass->availableSlabs.getUnchecked(i);
+            const auto& slabRange = slabs.getUnchecked(index)->range;
+
+            if (slabRange.getMemoryBlock()->getMemoryTypeIndex() == memoryTypeIndex && slabRange.getOffset() % requiredAlignment == 0
+                && slabRange.getHandle().block != compactionBlock)
+            {
+                slabIndex = index;
+                break;
+            }
+        }
+
+        if (slabIndex < 0)
+            slabIndex = createSlab(*slabClass, requiredAlignment, memoryTypeIndex);
+
+        auto& slab = *slabs.getUnchecked(slabIndex);
+
+        const auto slot = VulkanRangeAllocator::findLowestSetBit(slab.freeSlots);
+        slab.freeSlots &= ~(uint64_t(1) << slot);
+
+        if (slab.isFull())
+            slabClass->availableSlabs.removeFirstMatchingValue(slabIndex);
+
+        destRange = VulkanMemoryRange(*slab.range.getMemoryBlock(), slab.slotSize, slab.range.getOffset() + slab.slotSize * static_cast<vk::DeviceSize>(slot), false);
+
+        // Zero is left out, it's the generation of an empty handle
+        if (++slotGenerationCounter == 0)
+            ++slotGenerationCounter;
+
+        slab.slotGenerations[slot] = slotGenerationCounter;
+
+        destRange.handle.block = slab.range.getHandle().block;
+        destRange.handle.slot = slot;
+        destRange.handle.slab = slabIndex;
+        destRange.handle.generation = slotGenerationCounter;
+
+        return true;
+    }
+
+    /** The slab size is a quarter of the minimum block size, but at most 64 slots. */
+    int createSlab(SlabClass& slabClass, vk::DeviceSize requiredAlignment, uint32_t memoryTypeIndex)
+    {
+        auto slab = std::make_unique<Slab>();
+
+        slab->slotSize = slabClass.slotSize;
+        slab->numSlots = juce::jlimit(1, static_cast<int>(Slab::maxNumSlots), static_cast<int>((minBlockSize / 4) / slab->slotSize));
+        slab->freeSlots = slab->getAllSlots();
+
+        const auto slabSize = slab->slotSize * static_cast<vk::DeviceSize>(slab->numSlots);
+        const auto slabAlignment = std::max(requiredAlignment, slab->slotSize);
+
+        if (! acquireFromBlocks(slab->range, slabSize, slabAlignment, memoryTypeIndex))
+        {
+            const auto blockIndex = addBlock(allocateBlock(slabSize, memoryTypeIndex));
+
+            const auto acquired = blocks.getUnchecked(blockIndex)->acquireRange(slab->range, slabSize, slabAlignment);
+            jassert(acquired);
+
+            slab->range.handle.block = blockIndex;
+        }
+
+        // Reuse the slot of a released slab, so the indices of the remaining slabs stay valid
+        auto slabIndex = slabs.indexOf(nullptr);
+        if (slabIndex < 0)
+        {
+            slabIndex = slabs.size();
+            slabs.add(nullptr);
+        }
+
+        slabs.set(slabIndex, slab.release());
+        slabClass.availableSlabs.add(slabIndex);
+
+        return slabIndex;
+    }
+
+    void disposeSlabRange(const VulkanMemoryRange& range)
+    {
+        const auto& handle = range.getHandle();
+
+        const auto slabIndex = handle.slab;
+        const auto slab = slabs[slabIndex];
+
+        // Range was not acquired by this allocator or is already disposed
+        if (slab == nullptr || slab->range.getMemoryBlock() != range.getMemoryBlock() || handle.slot < 0 || handle.slot >= slab->numSlots
+            || (slab->freeSlots & (uint64_t(1) << handle.slot)) != 0 || slab->slotGenerations[handle.slot] != handle.generation)
+        {
+            jassertfalse;
+            return;
+        }
+
+        const auto wasFull = slab->isFull();
+        slab->freeSlots |= uint64_t(1) << range.getHandle().slot;
+
+        countFree(range);
+
+        auto slabClass = findSlabClass(slab->slotSize);
+
+        if (wasFull && slabClass != nullptr)
+            slabClass->availableSlabs.add(slabIndex);
+
+        // Keep the last available slab of a class, so a texture that is reloaded over and over doesn't churn the slab
+        if (slab->isEmpty() && (slabClass == nullptr || slabClass->availableSlabs.size() > 1 || isEvacuating(slab->range)))
+            releaseSlab(slabIndex);
+    }
+
+    void releaseSlab(int slabIndex)
+    {
+        const auto slab = slabs.getUnchecked(slabIndex);
+        jassert(slab->isEmpty());
+
+        if (auto slabClass = findSlabClass(slab->slotSize))
+            slabClass->availableSlabs.removeFirstMatchingValue(slabIndex);
+
+        if (auto block = blocks[slab->range.getHandle().block])
+            block->disposeRange(slab->range);
+
+        slabs.set(slabIndex, nullptr, true);
+
+        while (slabs.size() > 0 && slabs.getLast() == nullptr)
+            slabs.removeLast(1, true);
+    }
+
+    void releaseEmptySlabs()
+    {
+        for (int i = slabs.size(); --i >= 0;)
+            if (auto slab = slabs[i])
+                if (slab->isEmpty())
+                    releaseSlab(i);
+    }
+
+    //==============================================================================
+    int addBlock(std::unique_ptr<VulkanMemory> newBlock)
+    {
+        // Reuse the slot of a deallocated block, so the indices of the remaining blocks stay valid
+        auto blockIndex = blocks.indexOf(nullptr);
+        if (blockIndex < 0)
+        {
+            blockIndex = blocks.size();
+            blocks.add(nullptr);
+        }
+
+        blocks.set(blockIndex, newBlock.release());
+        removeCompactionTimeout(blockIndex);
+
+        peakBlockBytes = std::max(peakBlockBytes, size());
+
+        return blockIndex;
+    }
+
+    VulkanMemoryRange acquireFromNewBlock(std::unique_ptr<VulkanMemory> newBlock, vk::DeviceSize requiredSize, vk::DeviceSize requiredAlignment)
+    {
+        const auto blockIndex = addBlock(std::move(newBlock));
+        auto block = blocks.getUnchecked(blockIndex);
+
+        VulkanMemoryRange range;
+
+        const auto acquired = block->acquireRange(range, requiredSize, requiredAlignment);
+        jassert(acquired);
+
+        range.handle.block = blockIndex;
+        
+        return countAllocation(range);
+    }
+
+    const VulkanMemoryRange& countAllocation(const VulkanMemoryRange& range) noexcept
+    {
+        ++totalAllocations;
+
+        allocatedBytes += range.getSize();
+        peakAllocatedBytes = std::max(peakAllocatedBytes, allocatedBytes);
+
+        updateHighWaterMark();
+        updateRates();
+
+        return range;
+    }
+
+    void countFree(const VulkanMemoryRange& range) noexcept
+    {
+        ++totalFrees;
+
+        jassert(allocatedBytes >= range.getSize());
+        allocatedBytes -= range.getSize();
+
+        updateRates();
+    }
+
+    /** The high-water mark is the peak of two consecutive windows, so it decays 
+        one to two windows after the usage dropped. */
+    void updateHighWaterMark() noexcept
+    {
+        const auto time = juce::Time::getMillisecondCounter();
+
+        if (time - highWaterMarkWindowStart >= highWaterMarkWindow)
+        {
+            previousWindowPeak = currentWindowPeak;
+            currentWindowPeak = allocatedBytes;
+            highWaterMarkWindowStart = time;
+        }
+
+        currentWindowPeak = std::max(currentWindowPeak, allocatedBytes);
+    }
+
+    vk::DeviceSize highWaterMark() const noexcept { return std::max(currentWindowPeak, previousWindowPeak); }
+
+    /** Allocation and free rates are measured over windows of at least one second. */
+    void updateRates() const noexcept
+    {
+        const auto time = juce::Time::getMillisecondCounter();
+        const auto elapsed = time - rateWindowStart;
+
+        if (elapsed < 1000)
+            return;
+
+        const auto seconds = static_cast<double>(elapsed) / 1000.0;
+        const auto numAllocations = getTotalAllocations();
+        const auto numFrees = getTotalFrees();
+
+        allocationsPerSecond = static_cast<double>(numAllocations - rateWindowAllocations) / seconds;
+        freesPerSecond = static_cast<double>(numFrees - rateWindowFrees) / seconds;
+
+        rateWindowStart = time;
+        rateWindowAllocations = numAllocations;
+        rateWindowFrees = numFrees;
+    }
+
+    /** The offset alignment of a buffer view. The minimum covers all index types 
+        and the texel size of buffer to image copies. */
+    vk::DeviceSize getOffsetAlignment(vk::BufferUsageFlags usage) const noexcept
+    {
+        const auto& limits = device.getPhysicalDevice().getLimits();
+
+        vk::DeviceSize alignment = 16;
+
+        if (usage & vk::BufferUsageFlagBits::eUniformBuffer)
+            alignment = std::max(alignment, limits.minUniformBufferOffsetAlignment);
+
+        if (usage & vk::BufferUsageFlagBits::eStorageBuffer)
+            alignment = std::max(alignment, limits.minStorageBufferOffsetAlignment);
+
+        if (usage & (vk::BufferUsageFlagBits::eUniformTexelBuffer | vk::BufferUsageFlagBits::eStorageTexelBuffer))
+            alignment = std::max(alignment, limits.minTexelBufferOffsetAlignment);
+
+        if (usage & (vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst))
+            alignment = std::max(alignment, limits.optimalBufferCopyOffsetAlignment);
+
+        return alignment;
+    }
+
+    /** A block whose compaction timed out, with its allocated size at that time. Transient 
+        ranges that come and go don't make the block any easier to compact. */
+    struct CompactionTimeout
+    {
+        int block = -1;
+        vk::DeviceSize allocatedSize = 0;
+    };
+
+    bool hasCompactionTimedOut(int blockIndex) const noexcept
+    {
+        for (const auto& timeout : compactionTimeouts)
+            if (timeout.block == blockIndex)
+                return blocks.getUnchecked(blockIndex)->getAllocatedSize() >= timeout.allocatedSize;
+
+        return false;
+    }
+
+    void removeCompactionTimeout(int blockIndex) noexcept
+    {
+        for (int i = compactionTimeouts.size(); --i >= 0;)
+            if (compactionTimeouts.getReference(i).block == blockIndex)
+                compactionTimeouts.remove(i);
+    }
+
+    vk::DeviceSize getFreeSize(uint32_t memoryTypeIndex, int excludedBlock) const noexcept
+    {
+        vk::DeviceSize freeSize = 0;
+
+        for (int i = 0; i < blocks.size(); ++i)
+        {
+            const auto block = blocks.getUnchecked(i);
+
+            if (i != excludedBlock && block != nullptr && !block->isDedicated() && block->getMemoryTypeIndex() == memoryTypeIndex)
+                freeSize += block->getFreeSize();
+        }
+
+        return freeSize;
+    }
+
     std::unique_ptr<VulkanMemory> allocateBlock(vk::DeviceSize allocationSize, uint32_t memoryType) const noexcept
     {
         allocationSize = (allocationSize > minBlockSize) ? nextPowerOfTwo(allocationSize) : minBlockSize;
         return std::make_unique<VulkanMemory>(device, allocationSize, memoryType);
     }
 
-    uint32_t findMemoryType(uint32_t typeFilter, vk::MemoryPropertyFlags properties) const noexcept
+    /** The best ranked memory type, whose heap still has room for the allocation size. */
+    uint32_t findMemoryType(uint32_t typeFilter, vk::MemoryPropertyFlags properties, vk::DeviceSize allocationSize) const
     {
         const auto& memProperties = device.getPhysicalDevice().getMemoryProperties();
-        for (auto i = 0U; i < memProperties.memoryTypeCount; ++i)
+
+        const auto usage = VulkanMemoryUsage::forRequest(properties, memoryIntent);
+        const auto ranking = usage.rankMemoryTypes(memProperties, typeFilter);
+
+        if (ranking.isEmpty())
+        {
+            PW_DBG_V("Failed to find suitable memory type.");
+            jassertfalse;
+
+            return 0U;
+        }
+
+        for (const auto memoryTypeIndex : ranking)
         {
-            if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties)
-                return i;
+            if (hasHeapSpace(memProperties.memoryTypes[memoryTypeIndex].heapIndex, allocationSize))
+                return memoryTypeIndex;
+
+            PW_DBG_V("Memory heap " << juce::String(memProperties.memoryTypes[memoryTypeIndex].heapIndex) << " is exhausted, try the next memory type.");
         }
 
-        PW_DBG_V("Failed to find suitable memory type.");
-        jassertfalse;
+        // All heaps are exhausted, let the driver decide
+        return ranking.getFirst();
+    }
+
+    bool hasHeapSpace(uint32_t heapIndex, vk::DeviceSize allocationSize) const
+    {
+        const auto heapSize = device.getPhysicalDevice().getMemoryProperties().memoryHeaps[heapIndex].size;
+
+        // Far below the heap size, the budget doesn't have to be queried
+        if (device.getAllocatedSize(heapIndex) + allocationSize <= heapSize / 2)
+            return true;
 
-        return 0U;
+        return device.getMemoryBudgets()[static_cast<int>(heapIndex)].getAvailable() >= allocationSize;
     }
 
     void deallocateEmptyBlocks()
     {
+        releaseEmptySlabs();
+
         for (int i = blocks.size(); --i >= 0;)
         {
-            if (blocks[i]->isFree())
-                blocks.remove(i, true);
+            if (blocks[i] != nullptr && blocks[i]->isFree())
+            {
+                blocks.set(i, nullptr, true);
+
+                if (i == compactionBlock)
+                    compactionBlock = -1;
+            }
         }
+
+        removeTrailingSlots();
+    }
+
+    // Trailing empty slots can be removed without shifting any block index
+    void removeTrailingSlots()
+    {
+        while (blocks.size() > 0 && blocks.getLast() == nullptr)
+            blocks.removeLast(1, true);
     }
 
 private:
     const VulkanDevice& device;
     const vk::DeviceSize minBlockSize;
 
+    vk::DeviceSize dedicatedAllocationThreshold;
+
+    VulkanMemoryUsage::Intent memoryIntent = VulkanMemoryUsage::Intent::unspecified;
+
+    vk::BufferUsageFlags suballocationUsage;
+    vk::MemoryRequirements suballocationRequirements;
+
+    // Deallocated blocks leave an empty slot, since block indices are stored in the range handles.
     juce::OwnedArray<VulkanMemory> blocks;
 
+    bool concurrent = false;
+    bool useThreadCaches = true;
+    juce::CriticalSection lock;
+
+    // The key of the thread caches of this pool in the thread local storage
+    const juce::uint64 poolId = createPoolId();
+    juce::ReferenceCountedArray<ThreadCache> threadCaches;
+
+    // Released slabs leave an empty slot, since slab indices are stored in the range handles.
+    juce::OwnedArray<Slab> slabs;
+    juce::Array<SlabClass> slabClasses;
+
+    uint32_t slotGenerationCounter = 0;
+
+    std::atomic<int> compactionBlock { -1 };
+    juce::Time compactionStart;
+    juce::Array<CompactionTimeout> compactionTimeouts;
+
+    static constexpr juce::uint32 highWaterMarkWindow = 15000; // ms
+    static constexpr vk::DeviceSize maxGrowthBlocks = 4;
+
+    vk::DeviceSize reservedBytes = 0;
+
+    juce::uint32 highWaterMarkWindowStart = juce::Time::getMillisecondCounter();
+    vk::DeviceSize currentWindowPeak = 0;
+    vk::DeviceSize previousWindowPeak = 0;
+
+    vk::DeviceSize allocatedBytes = 0;
+    vk::DeviceSize peakAllocatedBytes = 0;
+    vk::DeviceSize peakBlockBytes = 0;
+
+    juce::uint64 totalAllocations = 0;
+    juce::uint64 totalFrees = 0;
+
+    mutable juce::uint32 rateWindowStart = juce::Time::getMillisecondCounter();
+    mutable juce::uint64 rateWindowAllocations = 0;
+    mutable juce::uint64 rateWindowFrees = 0;
+
+    mutable double allocationsPerSecond = 0.0;
+    mutable double freesPerSecond = 0.0;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VulkanMemoryPool)
 };
 
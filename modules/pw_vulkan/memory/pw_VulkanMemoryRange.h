@@ -39,6 +39,43 @@ class VulkanMemory;
 class VulkanMemoryRange final
 {
     friend class VulkanMemory;
+    friend class VulkanMemoryPool;
+
+public:
+    /** 
+        Identifies the allocation of a range, so it can be disposed without 
+        searching the pool. Stores the index of the block in the pool and 
+        the allocation slot in the block. Ranges served by a slab of the 
+        pool store the slab index and the slot in the slab instead.
+
+        Slots are reused by later allocations. Each allocation stamps its 
+        slot with a new generation, so a stale handle of a disposed range 
+        doesn't match the slot anymore.
+    */
+    class Handle final
+    {
+        friend class VulkanMemory;
+        friend class VulkanMemoryPool;
+
+    public:
+        Handle() = default;
+
+        bool isValid() const noexcept { return block >= 0 && slot >= 0; }
+
+        bool operator==(const Handle& other) const noexcept 
+        { 
+            return block == other.block && slot == other.slot && slab == other.slab && generation == other.generation; 
+        }
+
+        bool operator!=(const Handle& other) const noexcept { return !(*this == other); }
+
+    private:
+        int block = -1;
+        int slot = -1;
+        int slab = -1;
+
+        uint32_t generation = 0;
+    };
 
 public:
     VulkanMemoryRange() : memory(nullptr), memorySize(0), memoryOffset(0), free(false) {}
@@ -49,7 +86,7 @@ public:
     ~VulkanMemoryRange() = default;
 
     VulkanMemoryRange(const VulkanMemoryRange& other) noexcept :
-        memory(other.memory), memorySize(other.memorySize), memoryOffset(other.memoryOffset), free(other.free) {}
+        memory(other.memory), memorySize(other.memorySize), memoryOffset(other.memoryOffset), free(other.free), handle(other.handle) {}
 
     VulkanMemoryRange(VulkanMemoryRange&& other) noexcept :
         memory(nullptr), memorySize(0), memoryOffset(0), free(false)
@@ -66,6 +103,7 @@ public:
             memoryOffset = other.memoryOffset;
 
             free = other.free;
+            handle = other.handle;
         }
 
         return *this;
@@ -80,12 +118,14 @@ public:
             memoryOffset = other.memoryOffset;
 
             free = other.free;
+            handle = other.handle;
 
             other.memory = nullptr;
             other.memorySize = 0;
             other.memoryOffset = 0;
 
             other.free = false;
+            other.handle = Handle();
         }
 
         return *this;
@@ -94,7 +134,7 @@ public:
     bool operator==(const VulkanMemoryRange& other) const noexcept
     {
         if (memory == other.memory && getSize() == other.getSize() && 
-            getOffset() == other.getOffset() && isFree() == other.isFree())
+            getOffset() == other.getOffset() && isFree() == other.isFree() && handle == other.handle)
             return true;
 
         return false;
@@ -112,6 +152,8 @@ public:
 
     bool isEmpty() const noexcept { return getSize() == vk::DeviceSize(0); }
 
+    const Handle& getHandle() const noexcept { return handle; }
+
 private:
     const VulkanMemory* memory;
 
@@ -119,6 +161,8 @@ private:
     vk::DeviceSize memoryOffset;
 
     bool free;
+
+    Handle handle;
 };
 
 } // namespace parawave
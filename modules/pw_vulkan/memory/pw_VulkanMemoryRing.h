@@ -0,0 +1,178 @@
+/*
+  ==============================================================================
+
+   This file is part of the Parawave Vulkan C++ library.
+
+   The code included in this file is provided under the terms of the ISC license
+   https://opensource.org/licenses/ISC.
+
+   Copyright (c) 2021 - Parawave Audio (https://parawave-audio.com/vulkan-cpp-library)
+
+   Permission to use, copy, modify, and/or distribute this software for any 
+   purpose with or without fee is hereby granted, provided that the above 
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES 
+   WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF 
+   MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+   SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES 
+   WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+   OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN 
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace parawave
+{
+    
+//==============================================================================
+/** 
+    VulkanMemoryRing
+
+    A host visible buffer that stays mapped and is used to stream data that 
+    is only valid for one frame, like vertices. Every allocation just moves 
+    an offset forward, so no buffers are created or bound per allocation.
+
+    Once the GPU finished reading the data, e.g. after the frame fence was 
+    signaled, the entire ring is recycled with reset(). If a frame needs more 
+    memory than available, an additional buffer is created and the ring is 
+    resized to the combined size on the next reset.
+
+    The ring might use non-coherent memory. Call flush() once before the 
+    commands that read the allocations are submitted.
+*/
+class VulkanMemoryRing final
+{
+private:
+    VulkanMemoryRing() = delete;
+
+public:
+    struct Allocation
+    {
+        const VulkanBuffer* buffer = nullptr;
+        vk::DeviceSize offset = 0;
+
+        void* data = nullptr;
+
+        bool isValid() const noexcept { return buffer != nullptr; }
+    };
+
+public:
+    VulkanMemoryRing(VulkanMemoryPool& pool_, vk::DeviceSize ringSize, vk::BufferUsageFlags bufferUsage_) :
+        pool(pool_), bufferUsage(bufferUsage_)
+    {
+        addBuffer(ringSize);
+    }
+
+    ~VulkanMemoryRing() = default;
+
+    vk::DeviceSize size() const noexcept 
+    { 
+        vk::DeviceSize totalSize = 0;
+
+        for (auto& buffer : buffers)
+            totalSize += buffer->getSize();
+
+        return totalSize; 
+    }
+
+    Allocation allocate(vk::DeviceSize allocationSize, vk::DeviceSize alignment = 16)
+    {
+        jassert(alignment > 0);
+
+        auto offset = ((currentOffset + alignment - 1) / alignment) * alignment;
+
+        if (offset + allocationSize > buffers.getLast()->getSize())
+        {
+            addBuffer(std::max(allocationSize, buffers.getLast()->getSize()));
+            offset = 0;
+        }
+
+        const auto& buffer = *buffers.getLast();
+        jassert(buffer.isHostVisible());
+
+        currentOffset = offset + allocationSize;
+
+        Allocation allocation;
+
+        allocation.buffer = &buffer.getBuffer();
+        allocation.offset = buffer.getOffset() + offset;
+        allocation.data = static_cast<uint8_t*>(buffer.getData()) + offset;
+
+        return allocation;
+    }
+
+    Allocation write(const void* dataSrc, vk::DeviceSize dataSrcSize, vk::DeviceSize alignment = 16)
+    {
+        const auto allocation = allocate(dataSrcSize, alignment);
+        std::memcpy(allocation.data, dataSrc, static_cast<size_t>(dataSrcSize));
+
+        return allocation;
+    }
+
+    /** Flush everything written since the last flush with a single call. Does nothing for coherent memory. */
+    void flush()
+    {
+        std::vector<vk::MappedMemoryRange> ranges;
+
+        for (int i = flushedBuffer; i < buffers.size(); ++i)
+        {
+            const auto& buffer = *buffers.getUnchecked(i);
+
+            const auto begin = (i == flushedBuffer) ? flushedOffset : 0;
+            const auto end = (i == buffers.size() - 1) ? currentOffset : buffer.getSize();
+
+            if (end > begin && ! buffer.isHostCoherent())
+                ranges.push_back(buffer.getMappedRange(begin, end - begin));
+        }
+
+        VulkanMemory::flush(pool.getDevice(), ranges);
+
+        flushedBuffer = buffers.size() - 1;
+        flushedOffset = currentOffset;
+    }
+
+    /** Recycle all allocations. Make sure the GPU doesn't access any of them anymore! */
+    void reset()
+    {
+        // Also move the ring out of a block that is compacted by the pool
+        if (buffers.size() > 1 || pool.isEvacuating(buffers.getFirst()->getMemoryRange()))
+        {
+            const auto requiredSize = size();
+
+            buffers.clear(true);
+            addBuffer(requiredSize);
+        }
+
+        currentOffset = 0;
+
+        flushedBuffer = 0;
+        flushedOffset = 0;
+    }
+
+private:
+    void addBuffer(vk::DeviceSize bufferSize)
+    {
+        const auto createInfo = VulkanMemoryBuffer::CreateInfo(bufferSize, bufferUsage).setHostUpload();
+
+        buffers.add(new VulkanMemoryBuffer(pool, createInfo));
+        currentOffset = 0;
+    }
+
+private:
+    VulkanMemoryPool& pool;
+    const vk::BufferUsageFlags bufferUsage;
+
+    juce::OwnedArray<VulkanMemoryBuffer> buffers;
+    vk::DeviceSize currentOffset = 0;
+
+    int flushedBuffer = 0;
+    vk::DeviceSize flushedOffset = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VulkanMemoryRing)
+};
+
+} // namespace parawave
\ No newline at end of file
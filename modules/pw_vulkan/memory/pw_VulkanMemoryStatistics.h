@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+   This file is part of the Parawave Vulkan C++ library.
+
+   The code included in this file is provided under the terms of the ISC license
+   https://opensource.org/licenses/ISC.
+
+   Copyright (c) 2021 - Parawave Audio (https://parawave-audio.com/vulkan-cpp-library)
+
+   Permission to use, copy, modify, and/or distribute this software for any 
+   purpose with or without fee is hereby granted, provided that the above 
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES 
+   WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF 
+   MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+   SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES 
+   WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+   OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN 
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace parawave
+{
+   
+//==============================================================================
+/** 
+    VulkanMemoryStatistics
+
+    Usage of one or more memory blocks. The statistics of several blocks can be 
+    summed up, e.g. per memory type or for an entire pool.
+*/
+struct VulkanMemoryStatistics final
+{
+    /** 0 if all free memory is one contiguous range, close to 1 if the free memory 
+        is scattered over many small ranges. */
+    float getFragmentation() const noexcept
+    {
+        if (freeBytes == 0)
+            return 0.0f;
+
+        return 1.0f - static_cast<float>(largestFreeRange) / static_cast<float>(freeBytes);
+    }
+
+    VulkanMemoryStatistics& operator+= (const VulkanMemoryStatistics& other) noexcept
+    {
+        numBlocks += other.numBlocks;
+        numDedicatedBlocks += other.numDedicatedBlocks;
+        numAllocations += other.numAllocations;
+        numFreeRanges += other.numFreeRanges;
+
+        blockBytes += other.blockBytes;
+        allocatedBytes += other.allocatedBytes;
+        freeBytes += other.freeBytes;
+
+        largestFreeRange = std::max(largestFreeRange, other.largestFreeRange);
+
+        return *this;
+    }
+
+    juce::var toVar() const
+    {
+        auto object = new juce::DynamicObject();
+
+        if (memoryTypeIndex >= 0)
+            object->setProperty("memoryTypeIndex", memoryTypeIndex);
+
+        object->setProperty("numBlocks", numBlocks);
+        object->setProperty("numDedicatedBlocks", numDedicatedBlocks);
+        object->setProperty("numAllocations", numAllocations);
+        object->setProperty("numFreeRanges", numFreeRanges);
+        object->setProperty("blockBytes", static_cast<juce::int64>(blockBytes));
+        object->setProperty("allocatedBytes", static_cast<juce::int64>(allocatedBytes));
+        object->setProperty("freeBytes", static_cast<juce::int64>(freeBytes));
+        object->setProperty("largestFreeRange", static_cast<juce::int64>(largestFreeRange));
+        object->setProperty("fragmentation", getFragmentation());
+
+        return juce::var(object);
+    }
+
+    /** The memory type of the blocks, or -1 if the statistics include several types. */
+    int memoryTypeIndex = -1;
+
+    int numBlocks = 0;
+    int numDedicatedBlocks = 0;
+    int numAllocations = 0;
+    int numFreeRanges = 0;
+
+    vk::DeviceSize blockBytes = 0;
+    vk::DeviceSize allocatedBytes = 0;
+    vk::DeviceSize freeBytes = 0;
+    vk::DeviceSize largestFreeRange = 0;
+};
+
+} // namespace parawave
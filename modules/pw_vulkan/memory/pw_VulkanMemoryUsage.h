@@ -0,0 +1,173 @@
+/*
+  ==============================================================================
+
+   This file is part of the Parawave Vulkan C++ library.
+
+   The code included in this file is provided under the terms of the ISC license
+   https://opensource.org/licenses/ISC.
+
+   Copyright (c) 2021 - Parawave Audio (https://parawave-audio.com/vulkan-cpp-library)
+
+   Permission to use, copy, modify, and/or distribute this software for any 
+   purpose with or without fee is hereby granted, provided that the above 
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES 
+   WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF 
+   MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+   SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES 
+   WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+   OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN 
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace parawave
+{
+    
+//==============================================================================
+/** 
+    VulkanMemoryUsage
+
+    Selects the memory type for a resource by the way it is used. The required 
+    flags must be supported, preferred flags raise and avoided flags lower the 
+    score of a memory type. Types with the same score are ranked by the size of 
+    their heap. The ranking is also the fallback chain, if a heap is exhausted.
+
+    E.g. data that is written by the host every frame and read once by the GPU 
+    prefers device local host visible memory (resizable BAR), while staging 
+    buffers avoid it, so they don't take up the small BAR heap.
+*/
+struct VulkanMemoryUsage final
+{
+    enum class Intent
+    {
+        unspecified,
+
+        /** Written by the host every frame and read by the GPU, e.g. vertices. */
+        streamUpload,
+
+        /** Written by the host and copied to a device local resource. */
+        staging,
+
+        /** Written by the GPU and read by the host. */
+        readback,
+
+        /** Attachments that are rendered to and sampled by the GPU. */
+        renderTarget,
+
+        /** Resources that are uploaded once and only accessed by the GPU. */
+        staticResource
+    };
+
+    VulkanMemoryUsage(vk::MemoryPropertyFlags required_ = {}, vk::MemoryPropertyFlags preferred_ = {}, vk::MemoryPropertyFlags avoided_ = {}) noexcept :
+        required(required_), preferred(preferred_), avoided(avoided_) {}
+
+    static VulkanMemoryUsage forIntent(Intent intent) noexcept
+    {
+        using Flags = vk::MemoryPropertyFlagBits;
+
+        switch (intent)
+        {
+            case Intent::streamUpload:   return { Flags::eHostVisible, Flags::eDeviceLocal | Flags::eHostCoherent, Flags::eHostCached };
+            case Intent::staging:        return { Flags::eHostVisible, Flags::eHostCoherent, Flags::eDeviceLocal | Flags::eHostCached };
+            case Intent::readback:       return { Flags::eHostVisible, Flags::eHostCached | Flags::eHostCoherent, Flags::eDeviceLocal };
+            case Intent::renderTarget:
+            case Intent::staticResource: return { Flags::eDeviceLocal, {}, Flags::eHostVisible };
+            case Intent::unspecified:
+            default:                     return {};
+        }
+    }
+
+    /** The usage for the memory properties of a single request, refined by the intent 
+        of the pool. Host cached memory is only preferred, the other properties are required. 
+        Memory that isn't host visible avoids host visible types, to keep them for the host. */
+    static VulkanMemoryUsage forRequest(vk::MemoryPropertyFlags memoryProperties, Intent intent) noexcept
+    {
+        using Flags = vk::MemoryPropertyFlagBits;
+
+        const auto hostFlags = Flags::eHostVisible | Flags::eHostCoherent | Flags::eHostCached;
+
+        auto usage = forIntent(intent);
+
+        usage.required = memoryProperties & ~vk::MemoryPropertyFlags(Flags::eHostCached);
+        usage.preferred |= memoryProperties & Flags::eHostCached;
+
+        if (! (usage.required & Flags::eHostVisible))
+        {
+            usage.preferred &= ~hostFlags;
+            usage.avoided |= Flags::eHostVisible;
+        }
+
+        usage.preferred &= ~usage.required;
+        usage.avoided &= ~(usage.required | usage.preferred);
+
+        return usage;
+    }
+
+    /** The score of a memory type or -1 if it doesn't support the required flags. */
+    int getScore(vk::MemoryPropertyFlags typeFlags) const noexcept
+    {
+        using Flags = vk::MemoryPropertyFlagBits;
+
+        // Never pick special memory, unless it is explicitly requested
+        const auto specialFlags = vk::MemoryPropertyFlags(Flags::eProtected | Flags::eLazilyAllocated) & ~required;
+
+        if ((typeFlags & required) != required || (typeFlags & specialFlags))
+            return -1;
+
+        const auto numPreferred = juce::countNumberOfBits(static_cast<uint32_t>(typeFlags & preferred));
+        const auto numAvoided = juce::countNumberOfBits(static_cast<uint32_t>(typeFlags & avoided));
+
+        return 32 + numPreferred - numAvoided;
+    }
+
+    /** All memory types of the filter that support the required flags, best first. */
+    juce::Array<uint32_t> rankMemoryTypes(const vk::PhysicalDeviceMemoryProperties& memoryProperties, uint32_t typeFilter) const
+    {
+        juce::Array<uint32_t> ranking;
+        juce::Array<int> scores;
+
+        for (auto i = 0U; i < memoryProperties.memoryTypeCount; ++i)
+        {
+            if (! (typeFilter & (1U << i)))
+                continue;
+
+            const auto& memoryType = memoryProperties.memoryTypes[i];
+            const auto score = getScore(memoryType.propertyFlags);
+
+            if (score < 0)
+                continue;
+
+            const auto heapSize = memoryProperties.memoryHeaps[memoryType.heapIndex].size;
+
+            // Insertion sort, there are only a few memory types. Equal types keep their order.
+            auto position = ranking.size();
+
+            while (position > 0)
+            {
+                const auto& other = memoryProperties.memoryTypes[ranking.getUnchecked(position - 1)];
+                const auto otherScore = scores.getUnchecked(position - 1);
+
+                if (otherScore > score || (otherScore == score && memoryProperties.memoryHeaps[other.heapIndex].size >= heapSize))
+                    break;
+
+                --position;
+            }
+
+            ranking.insert(position, i);
+            scores.insert(position, score);
+        }
+
+        return ranking;
+    }
+
+    vk::MemoryPropertyFlags required;
+    vk::MemoryPropertyFlags preferred;
+    vk::MemoryPropertyFlags avoided;
+};
+
+} // namespace parawave
@@ -0,0 +1,498 @@
+/*
+  ==============================================================================
+
+   This file is part of the Parawave Vulkan C++ library.
+
+   The code included in this file is provided under the terms of the ISC license
+   https://opensource.org/licenses/ISC.
+
+   Copyright (c) 2021 - Parawave Audio (https://parawave-audio.com/vulkan-cpp-library)
+
+   Permission to use, copy, modify, and/or distribute this software for any 
+   purpose with or without fee is hereby granted, provided that the above 
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES 
+   WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF 
+   MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+   SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES 
+   WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+   OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN 
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace parawave
+{
+  
+//==============================================================================
+/** 
+    VulkanRangeAllocator
+
+    Manages the ranges of a fixed size address space, e.g. a block of device 
+    memory. It doesn't touch any memory itself, so it can also be used and 
+    measured without a device.
+
+    Ranges are managed by a two-level segregated fit (TLSF) allocator. Free 
+    ranges are sorted into power of two size classes (first level), each split 
+    into linear sub classes (second level). Two bitmaps allow to find a fitting 
+    free range in constant time, and a freed range is immediately merged with 
+    its free physical neighbours.
+
+    Every allocation stamps its slot with a new generation, so a stale 
+    allocation of a reused slot can be told apart from the live one.
+*/
+class VulkanRangeAllocator final
+{
+private:
+    enum
+    {
+        secondLevelIndexLog2 = 5,
+        secondLevelIndexCount = 1 << secondLevelIndexLog2,
+
+        granularityLog2 = 4,
+        granularity = 1 << granularityLog2,
+
+        firstLevelIndexShift = secondLevelIndexLog2 + granularityLog2,
+        firstLevelIndexMax = 48,
+        firstLevelIndexCount = firstLevelIndexMax - firstLevelIndexShift + 1,
+
+        smallRangeSize = 1 << firstLevelIndexShift,
+
+        minNumNodes = 16
+    };
+
+    /** A physical range of the address space. Nodes are linked to their 
+        physical neighbours and, if free, to the other free nodes of the 
+        same size class. */
+    struct Node
+    {
+        vk::DeviceSize offset = 0;
+        vk::DeviceSize size = 0;
+
+        int prevPhysical = -1;
+        int nextPhysical = -1;
+
+        int prevFree = -1;
+        int nextFree = -1;
+
+        // Stamped by every allocation of the node, never zero for an allocated node
+        uint32_t generation = 0;
+
+        bool free = false;
+    };
+
+public:
+    /** An allocated range and the slot of its node. */
+    struct Allocation
+    {
+        vk::DeviceSize offset = 0;
+        vk::DeviceSize size = 0;
+
+        int slot = -1;
+        uint32_t generation = 0;
+    };
+
+public:
+    explicit VulkanRangeAllocator(vk::DeviceSize totalSize_) : totalSize(totalSize_)
+    {
+        jassert(totalSize < (vk::DeviceSize(1) << firstLevelIndexMax));
+
+        for (auto& lists : freeLists)
+            std::fill(std::begin(lists), std::end(lists), -1);
+
+        auto& node = nodes.getReference(createNode());
+        node.size = totalSize;
+
+        insertFreeNode(0);
+    }
+
+    ~VulkanRangeAllocator() = default;
+
+    vk::DeviceSize size() const noexcept { return totalSize; }
+
+    /** True if the slot holds the allocation with the generation and offset. */
+    bool isAllocated(int slot, uint32_t generation, vk::DeviceSize offset) const noexcept
+    {
+        if (slot < 0 || slot >= nodes.size())
+            return false;
+
+        const auto& node = nodes.getReference(slot);
+        return !node.free && node.generation == generation && node.offset == offset;
+    }
+
+    bool isFree() const noexcept { return numAllocations == 0; }
+
+    int getNumAllocations() const noexcept { return numAllocations; }
+
+    /** The size of all allocated ranges, without the free space in between. */
+    vk::DeviceSize getAllocatedSize() const noexcept { return allocatedSize; }
+
+    int getNumFreeRanges() const noexcept
+    {
+        auto numFreeRanges = 0;
+
+        for (auto index = 0; index != -1; index = nodes.getReference(index).nextPhysical)
+            if (nodes.getReference(index).free)
+                ++numFreeRanges;
+
+        return numFreeRanges;
+    }
+
+    vk::DeviceSize getLargestFreeRange() const noexcept
+    {
+        vk::DeviceSize largestFreeRange = 0;
+
+        for (auto index = 0; index != -1; index = nodes.getReference(index).nextPhysical)
+        {
+            const auto& node = nodes.getReference(index);
+
+            if (node.free)
+                largestFreeRange = std::max(largestFreeRange, node.size);
+        }
+
+        return largestFreeRange;
+    }
+
+    bool allocate(Allocation& destAllocation, vk::DeviceSize rangeSize, vk::DeviceSize rangeAlignment)
+    {
+        // Address space too small for the requested range size
+        if(rangeSize == 0 || rangeSize > totalSize)
+            return false;
+
+        rangeAlignment = std::max(rangeAlignment, vk::DeviceSize(1));
+
+        // Search a size class that fits the range at any alignment offset. If there is none, 
+        // the first range of the exact size class might still fit if its offset is already aligned.
+        auto index = findFreeNode(rangeSize + rangeAlignment - 1);
+        
+        if (index == -1)
+        {
+            index = getFirstFreeNode(rangeSize);
+
+            if (index == -1 || !fits(nodes.getReference(index), rangeSize, rangeAlignment))
+                return false;
+        }
+
+        removeFreeNode(index);
+
+        const auto alignedOffset = alignOffset(nodes.getReference(index).offset, rangeAlignment);
+
+        // Reclaim the alignment padding as a separate free range
+        {
+            const auto padding = alignedOffset - nodes.getReference(index).offset;
+            if (padding > 0)
+            {
+                const auto paddingIndex = index;
+                index = splitNode(paddingIndex, padding);
+
+                insertFreeNode(paddingIndex);
+            }
+        }
+
+        // If the requested range is smaller than the found range, split it up!
+        {
+            const auto remainingSize = nodes.getReference(index).size - rangeSize;
+            if (remainingSize >= granularity)
+                insertFreeNode(splitNode(index, rangeSize));
+        }
+
+        auto& node = nodes.getReference(index);
+        jassert(node.offset == alignedOffset && node.size >= rangeSize);
+
+        ++numAllocations;
+        allocatedSize += node.size;
+
+        node.generation = nextGeneration();
+
+        destAllocation.offset = node.offset;
+        destAllocation.size = node.size;
+        destAllocation.slot = index;
+        destAllocation.generation = node.generation;
+        
+        return true;
+    }
+
+    /** The slot must hold a live allocation, see isAllocated(). */
+    void free(int slot) noexcept
+    {
+        auto index = slot;
+        jassert(! nodes.getReference(index).free);
+        
+        --numAllocations;
+        allocatedSize -= nodes.getReference(index).size;
+
+        // Merge with the free physical neighbours
+        {
+            const auto next = nodes.getReference(index).nextPhysical;
+            if (next != -1 && nodes.getReference(next).free)
+            {
+                removeFreeNode(next);
+                mergeWithNext(index);
+            }
+        }
+
+        {
+            const auto prev = nodes.getReference(index).prevPhysical;
+            if (prev != -1 && nodes.getReference(prev).free)
+            {
+                removeFreeNode(prev);
+                mergeWithNext(prev);
+
+                index = prev;
+            }
+        }
+
+        insertFreeNode(index);
+    }
+
+    void printRanges() const
+    {
+        DBG("Memory Ranges: ");
+
+        // The first node always starts at offset zero, since it never needs alignment padding.
+        for (auto index = 0; index != -1; index = nodes.getReference(index).nextPhysical)
+        {
+            const auto& node = nodes.getReference(index);
+            DBG("Range [" << (node.free ? " " : "X") << "] [offset = " << node.offset << ", size = " << node.size << "]");
+        }
+
+        DBG("Total [offset = " << 0 << ", size = " << totalSize << "]");
+    }
+
+public:
+    /** Bit scans of the free list bitmaps, also used for the slot bitmaps of pool slabs. */
+    static int findLowestSetBit(uint64_t value) noexcept
+    {
+        jassert(value != 0);
+
+       #if JUCE_MSVC
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return static_cast<int>(index);
+       #else
+        return __builtin_ctzll(value);
+       #endif
+    }
+
+    static int findHighestSetBit(uint64_t value) noexcept
+    {
+        jassert(value != 0);
+
+       #if JUCE_MSVC
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return static_cast<int>(index);
+       #else
+        return 63 - __builtin_clzll(value);
+       #endif
+    }
+
+private:
+    static vk::DeviceSize alignOffset(vk::DeviceSize offset, vk::DeviceSize alignment) noexcept
+    {
+        return ((offset + alignment - 1) / alignment) * alignment;
+    }
+
+    static bool fits(const Node& node, vk::DeviceSize rangeSize, vk::DeviceSize rangeAlignment) noexcept
+    {
+        return alignOffset(node.offset, rangeAlignment) + rangeSize <= node.offset + node.size;
+    }
+
+    // The size class (first level, second level) a free range of the given size is stored in.
+    static std::pair<int, int> getSizeClass(vk::DeviceSize rangeSize) noexcept
+    {
+        if (rangeSize < smallRangeSize)
+            return std::make_pair(0, static_cast<int>(rangeSize / granularity));
+
+        const auto highestBit = findHighestSetBit(rangeSize);
+        const auto secondLevel = static_cast<int>(rangeSize >> (highestBit - secondLevelIndexLog2)) ^ secondLevelIndexCount;
+
+        return std::make_pair(highestBit - (firstLevelIndexShift - 1), secondLevel);
+    }
+
+    // Round up the size, so every range of the resulting size class is big enough.
+    static vk::DeviceSize roundUpToSizeClass(vk::DeviceSize rangeSize) noexcept
+    {
+        if (rangeSize < smallRangeSize)
+            return (rangeSize + granularity - 1) & ~static_cast<vk::DeviceSize>(granularity - 1);
+
+        return rangeSize + (vk::DeviceSize(1) << (findHighestSetBit(rangeSize) - secondLevelIndexLog2)) - 1;
+    }
+
+    int findFreeNode(vk::DeviceSize rangeSize) const noexcept
+    {
+        int firstLevel, secondLevel;
+        std::tie(firstLevel, secondLevel) = getSizeClass(roundUpToSizeClass(rangeSize));
+
+        if (firstLevel >= firstLevelIndexCount)
+            return -1;
+
+        auto secondLevelMap = secondLevelBitmap[firstLevel] & (~0U << secondLevel);
+        if (secondLevelMap == 0)
+        {
+            const auto firstLevelMap = firstLevelBitmap & (~uint64_t(0) << (firstLevel + 1));
+            if (firstLevelMap == 0)
+                return -1;
+
+            firstLevel = findLowestSetBit(firstLevelMap);
+            secondLevelMap = secondLevelBitmap[firstLevel];
+        }
+
+        return freeLists[firstLevel][findLowestSetBit(secondLevelMap)];
+    }
+
+    int getFirstFreeNode(vk::DeviceSize rangeSize) const noexcept
+    {
+        int firstLevel, secondLevel;
+        std::tie(firstLevel, secondLevel) = getSizeClass(rangeSize);
+
+        return freeLists[firstLevel][secondLevel];
+    }
+
+    void insertFreeNode(int index) noexcept
+    {
+        auto& node = nodes.getReference(index);
+
+        int firstLevel, secondLevel;
+        std::tie(firstLevel, secondLevel) = getSizeClass(node.size);
+
+        auto& head = freeLists[firstLevel][secondLevel];
+
+        node.free = true;
+        node.prevFree = -1;
+        node.nextFree = head;
+
+        if (head != -1)
+            nodes.getReference(head).prevFree = index;
+
+        head = index;
+
+        firstLevelBitmap |= uint64_t(1) << firstLevel;
+        secondLevelBitmap[firstLevel] |= 1U << secondLevel;
+    }
+
+    void removeFreeNode(int index) noexcept
+    {
+        auto& node = nodes.getReference(index);
+        jassert(node.free);
+
+        int firstLevel, secondLevel;
+        std::tie(firstLevel, secondLevel) = getSizeClass(node.size);
+
+        if (node.nextFree != -1)
+            nodes.getReference(node.nextFree).prevFree = node.prevFree;
+
+        if (node.prevFree != -1)
+        {
+            nodes.getReference(node.prevFree).nextFree = node.nextFree;
+        }
+        else
+        {
+            auto& head = freeLists[firstLevel][secondLevel];
+            head = node.nextFree;
+
+            if (head == -1)
+            {
+                secondLevelBitmap[firstLevel] &= ~(1U << secondLevel);
+
+                if (secondLevelBitmap[firstLevel] == 0)
+                    firstLevelBitmap &= ~(uint64_t(1) << firstLevel);
+            }
+        }
+
+        node.free = false;
+        node.prevFree = -1;
+        node.nextFree = -1;
+    }
+
+    // Split the node at the given size and return the index of the node behind it.
+    int splitNode(int index, vk::DeviceSize splitSize)
+    {
+        const auto newIndex = createNode();
+
+        auto& node = nodes.getReference(index);
+        auto& newNode = nodes.getReference(newIndex);
+
+        jassert(splitSize < node.size);
+
+        newNode.offset = node.offset + splitSize;
+        newNode.size = node.size - splitSize;
+        newNode.prevPhysical = index;
+        newNode.nextPhysical = node.nextPhysical;
+
+        if (node.nextPhysical != -1)
+            nodes.getReference(node.nextPhysical).prevPhysical = newIndex;
+
+        node.size = splitSize;
+        node.nextPhysical = newIndex;
+
+        return newIndex;
+    }
+
+    // Merge the next physical node into the node at the given index.
+    void mergeWithNext(int index) noexcept
+    {
+        auto& node = nodes.getReference(index);
+
+        const auto nextIndex = node.nextPhysical;
+        jassert(nextIndex != -1);
+
+        const auto& next = nodes.getReference(nextIndex);
+
+        node.size += next.size;
+        node.nextPhysical = next.nextPhysical;
+
+        if (next.nextPhysical != -1)
+            nodes.getReference(next.nextPhysical).prevPhysical = index;
+
+        releaseNode(nextIndex);
+    }
+
+    uint32_t nextGeneration() noexcept
+    {
+        // Zero is left out, it's the generation of an empty handle
+        if (++generationCounter == 0)
+            ++generationCounter;
+
+        return generationCounter;
+    }
+
+    int createNode()
+    {
+        if (! unusedNodes.isEmpty())
+            return unusedNodes.removeAndReturn(unusedNodes.size() - 1);
+
+        nodes.add(Node());
+        return nodes.size() - 1;
+    }
+
+    void releaseNode(int index) noexcept
+    {
+        nodes.getReference(index) = Node();
+        unusedNodes.add(index);
+    }
+
+private:
+    const vk::DeviceSize totalSize;
+
+    juce::Array<Node, juce::DummyCriticalSection, minNumNodes> nodes;
+    juce::Array<int> unusedNodes;
+
+    int numAllocations = 0;
+    vk::DeviceSize allocatedSize = 0;
+
+    uint32_t generationCounter = 0;
+
+    uint64_t firstLevelBitmap = 0;
+    uint32_t secondLevelBitmap[firstLevelIndexCount] = {};
+
+    int freeLists[firstLevelIndexCount][secondLevelIndexCount];
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VulkanRangeAllocator)
+};
+
+} // namespace parawave
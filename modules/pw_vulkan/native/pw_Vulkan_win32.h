@@ -58,7 +58,7 @@ public:
         vk::Result result;
                 
         jassert(instance.getHandle());
-        std::tie(result, handle) = instance.getHandle().createWin32SurfaceKHRUnique(createInfo).asTuple();
+        std::tie(result, handle) = instance.getHandle().createWin32SurfaceKHRUnique(createInfo, instance.getAllocationCallbacks()).asTuple();
 
         PW_CHECK_VK_RESULT_SUCCESS(result, "Couldn't create Win32SurfaceKHR.");
 
@@ -95,3 +95,5 @@ namespace parawave
 #include "vulkan/pw_VulkanPhysicalDevice.cpp"
 #include "vulkan/pw_VulkanDevice.cpp"
 #include "vulkan/pw_VulkanSwapchain.cpp"
+
+#include "memory/pw_VulkanMemoryBenchmarks.cpp"
@@ -94,6 +94,7 @@
 *******************************************************************************/
 #include <array>
 #include <algorithm>
+#include <atomic>
 
 /*******************************************************************************
   JUCE SDK
@@ -113,6 +114,7 @@ namespace parawave
     class VulkanBufferView;
     class VulkanCommandBuffer;
     class VulkanCommandPool;
+    class VulkanCommandRecycler;
     class VulkanContext;
     class VulkanDebugUtilsMessenger;
     class VulkanDescriptorPool;
@@ -122,10 +124,14 @@ namespace parawave
     class VulkanDeviceMemory;
     class VulkanFence;
     class VulkanFramebuffer;
+    class VulkanHostAllocator;
+    class VulkanHostMemoryBuffer;
     class VulkanImage;
     class VulkanImageView;
     class VulkanInstance;
+    class VulkanMemoryBuffer;
     class VulkanNativeSurface;
+    class VulkanParallelRecorder;
     class VulkanPipeline;
     class VulkanPipelineLayout;
     class VulkanPhysicalDevice;
@@ -134,8 +140,10 @@ namespace parawave
     class VulkanSemaphore;
     class VulkanShaderModule;
     class VulkanSurface;
+    class VulkanSubmitBatch;
     class VulkanSurfaceKHR;
     class VulkanSwapchain;
+    class VulkanTimeline;
     
 } // namespace parawave
 
@@ -146,6 +154,7 @@ namespace parawave
 #include "utils/pw_Macros.h"
 #include "utils/pw_VulkanConversion.h"
 
+#include "vulkan/pw_VulkanHostAllocator.h"
 #include "vulkan/pw_VulkanInstance.h"
 #include "vulkan/pw_VulkanDebugUtilsMessenger.h"
 #include "vulkan/pw_VulkanPhysicalDevice.h"
@@ -174,16 +183,26 @@ namespace parawave
 #include "vulkan/pw_VulkanFramebuffer.h"
 
 #include "memory/pw_VulkanMemoryRange.h"
+#include "memory/pw_VulkanMemoryStatistics.h"
+#include "memory/pw_VulkanRangeAllocator.h"
 #include "memory/pw_VulkanMemory.h"
+#include "memory/pw_VulkanMemoryUsage.h"
 #include "memory/pw_VulkanMemoryPool.h"
 #include "memory/pw_VulkanMemoryBuffer.h"
 #include "memory/pw_VulkanMemoryImage.h"
+#include "memory/pw_VulkanMemoryRing.h"
+#include "memory/pw_VulkanHostMemoryBuffer.h"
 
 #include "descriptor/pw_VulkanDescriptorSetPool.h"
 #include "descriptor/pw_VulkanDescriptor.h"
 
+#include "utils/pw_VulkanTimeline.h"
+#include "utils/pw_VulkanCommandRecycler.h"
+#include "utils/pw_VulkanSubmitBatch.h"
 #include "utils/pw_VulkanCommandSequence.h"
 #include "utils/pw_VulkanBufferTransfer.h"
 #include "utils/pw_VulkanImageTransfer.h"
+#include "utils/pw_VulkanHostImageTransfer.h"
+#include "utils/pw_VulkanParallelRecorder.h"
 #include "utils/pw_VulkanComputePipeline.h"
 #include "utils/pw_VulkanGraphicsPipeline.h"
\ No newline at end of file
@@ -37,7 +37,7 @@ namespace parawave
 class VulkanBufferTransfer : public VulkanCommandSequence
 {
 public:
-    VulkanBufferTransfer(const VulkanDevice& device_, const VulkanBuffer& buffer_, const VulkanBuffer& stagingBuffer_) :
+    VulkanBufferTransfer(const VulkanDevice& device_, const VulkanMemoryBuffer& buffer_, const VulkanMemoryBuffer& stagingBuffer_) :
         VulkanCommandSequence(device_), buffer(buffer_), stagingBuffer(stagingBuffer_) {}
 
     ~VulkanBufferTransfer() override = default;
@@ -57,8 +57,8 @@ public:
     }
 
 private:
-    const VulkanBuffer& buffer;
-    const VulkanBuffer& stagingBuffer;
+    const VulkanMemoryBuffer& buffer;
+    const VulkanMemoryBuffer& stagingBuffer;
 
 private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VulkanBufferTransfer)
@@ -0,0 +1,171 @@
+/*
+  ==============================================================================
+
+   This file is part of the Parawave Vulkan C++ library.
+
+   The code included in this file is provided under the terms of the ISC license
+   https://opensource.org/licenses/ISC.
+
+   Copyright (c) 2021 - Parawave Audio (https://parawave-audio.com/vulkan-cpp-library)
+
+   Permission to use, copy, modify, and/or distribute this software for any 
+   purpose with or without fee is hereby granted, provided that the above 
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES 
+   WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF 
+   MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+   SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES 
+   WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+   OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN 
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+  ==============================================================================
+*/
+
+
+#pragma once
+
+namespace parawave
+{
+
+//==============================================================================
+/** 
+    VulkanCommandRecycler
+
+    Keeps the command buffers and binary semaphores of completed submissions, 
+    and hands them out again instead of creating new driver objects. Command 
+    buffers of the graphics command pool are reset implicitly by begin(), so 
+    their memory is reused for the next recording.
+
+    Only return objects that are no longer used by the device: a command buffer 
+    once its commands have completed, a semaphore once it was waited on and the 
+    wait has completed. A signaled semaphore can't be signaled again.
+
+    The statistics count the created and reused objects. Once all submits are 
+    recycled, the number of created objects stops growing.
+*/
+class VulkanCommandRecycler final
+{
+public:
+    struct Statistics final
+    {
+        juce::var toVar() const
+        {
+            auto object = new juce::DynamicObject();
+
+            object->setProperty("numCreatedCommandBuffers", numCreatedCommandBuffers);
+            object->setProperty("numReusedCommandBuffers", numReusedCommandBuffers);
+            object->setProperty("numFreeCommandBuffers", numFreeCommandBuffers);
+            object->setProperty("numCreatedSemaphores", numCreatedSemaphores);
+            object->setProperty("numReusedSemaphores", numReusedSemaphores);
+            object->setProperty("numFreeSemaphores", numFreeSemaphores);
+
+            return juce::var(object);
+        }
+
+        juce::int64 numCreatedCommandBuffers = 0;
+        juce::int64 numReusedCommandBuffers = 0;
+        int numFreeCommandBuffers = 0;
+
+        juce::int64 numCreatedSemaphores = 0;
+        juce::int64 numReusedSemaphores = 0;
+        int numFreeSemaphores = 0;
+    };
+
+private:
+    VulkanCommandRecycler() = delete;
+
+    /** More free objects than this are destroyed, e.g. after a burst of uploads. */
+    enum { maxNumFreeObjects = 64 };
+
+public:
+    explicit VulkanCommandRecycler(const VulkanDevice& device_) : device(device_) {}
+
+    ~VulkanCommandRecycler() = default;
+
+    /** A primary command buffer of the graphics command pool. */
+    std::unique_ptr<VulkanCommandBuffer> getCommandBuffer()
+    {
+        {
+            const juce::ScopedLock sl(lock);
+
+            if (! freeCommandBuffers.isEmpty())
+            {
+                ++statistics.numReusedCommandBuffers;
+                return std::unique_ptr<VulkanCommandBuffer>(freeCommandBuffers.removeAndReturn(freeCommandBuffers.size() - 1));
+            }
+
+            ++statistics.numCreatedCommandBuffers;
+        }
+
+        return std::make_unique<VulkanCommandBuffer>(device);
+    }
+
+    /** A binary semaphore, that is unsignaled. */
+    std::unique_ptr<VulkanSemaphore> getSemaphore()
+    {
+        {
+            const juce::ScopedLock sl(lock);
+
+            if (! freeSemaphores.isEmpty())
+            {
+                ++statistics.numReusedSemaphores;
+                return std::unique_ptr<VulkanSemaphore>(freeSemaphores.removeAndReturn(freeSemaphores.size() - 1));
+            }
+
+            ++statistics.numCreatedSemaphores;
+        }
+
+        return std::make_unique<VulkanSemaphore>(device);
+    }
+
+    void recycle(std::unique_ptr<VulkanCommandBuffer> commandBuffer)
+    {
+        if (commandBuffer == nullptr)
+            return;
+
+        const juce::ScopedLock sl(lock);
+
+        if (freeCommandBuffers.size() < maxNumFreeObjects)
+            freeCommandBuffers.add(commandBuffer.release());
+    }
+
+    void recycle(std::unique_ptr<VulkanSemaphore> semaphore)
+    {
+        if (semaphore == nullptr)
+            return;
+
+        jassert(! semaphore->isTimeline());
+
+        const juce::ScopedLock sl(lock);
+
+        if (freeSemaphores.size() < maxNumFreeObjects)
+            freeSemaphores.add(semaphore.release());
+    }
+
+    Statistics getStatistics() const
+    {
+        const juce::ScopedLock sl(lock);
+
+        auto result = statistics;
+        result.numFreeCommandBuffers = freeCommandBuffers.size();
+        result.numFreeSemaphores = freeSemaphores.size();
+
+        return result;
+    }
+
+private:
+    const VulkanDevice& device;
+
+    juce::CriticalSection lock;
+
+    juce::OwnedArray<VulkanCommandBuffer> freeCommandBuffers;
+    juce::OwnedArray<VulkanSemaphore> freeSemaphores;
+
+    Statistics statistics;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VulkanCommandRecycler)
+};
+
+} // namespace parawave
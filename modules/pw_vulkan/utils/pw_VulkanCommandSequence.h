@@ -34,6 +34,19 @@ namespace parawave
 
     Helper class to submit commands (and chain command buffers) with semaphores 
     and optional fence. 
+
+    If a submit batch is set, the command buffers are added to the batch instead 
+    of being submitted on their own. The completion is then tracked by the fence 
+    of the batch.
+
+    If the device has a timeline, every submit signals the next timeline value and 
+    waits for the value of the previous submit. No semaphores are created and the 
+    completion is a comparison with the counter of the timeline.
+
+    The command buffers and semaphores come from the VulkanCommandRecycler of the 
+    device. They're returned once their submit has completed, so a sequence that 
+    is used for many submits doesn't grow. A sequence must not be destroyed before 
+    its commands have completed.
 */
 class VulkanCommandSequence
 {
@@ -89,9 +102,21 @@ private:
 
 public:
     explicit VulkanCommandSequence(const VulkanDevice& device_) :
-        device(device_), completedFence(device) {}
+        device(device_), timeline(device_.getTimeline()), completedFence(device) {}
 
-    virtual ~VulkanCommandSequence() = default;
+    virtual ~VulkanCommandSequence()
+    {
+        auto& recycler = device.getCommandRecycler();
+
+        for (auto submission : submissions)
+        {
+            recycler.recycle(std::move(submission->commandBuffer));
+
+            // Only a semaphore that was waited on is unsignaled again, the last one is destroyed
+            if (submission != submissions.getLast())
+                recycler.recycle(std::move(submission->signalSemaphore));
+        }
+    }
 
     const VulkanSemaphore* getCurrentWaitSemaphore() const noexcept { return currentWaitSemaphore; }
 
@@ -99,25 +124,84 @@ public:
 
     const VulkanFence& getCompletedFence() const noexcept { return completedFence; }
 
+    /** Add the following submits to the batch. Set it before the first submit. Once the 
+        batch is destroyed, its submits count as completed and the sequence submits directly. */
+    void setSubmitBatch(VulkanSubmitBatch* newSubmitBatch) noexcept 
+    { 
+        submitBatch = newSubmitBatch; 
+        useSubmitBatch = newSubmitBatch != nullptr;
+    }
+
+    VulkanSubmitBatch* getSubmitBatch() const noexcept { return submitBatch.get(); }
+
+    /** True if the commands submitted with a fence have completed. */
+    bool isCompleted() const noexcept
+    {
+        if (useSubmitBatch)
+        {
+            auto* batch = submitBatch.get();
+            return batch == nullptr || batch->isCompleted(batchGeneration);
+        }
+
+        if (timeline != nullptr)
+            return timeline->isCompleted(timelineValue);
+
+        return completedFence.isSignaled();
+    }
+
     template<typename CommandsFunction>
     void submit(const CommandsFunction& commandsFunction, bool useFence = false)
     {
-        auto commandBuffer = commandBuffers.add(new VulkanCommandBuffer(device));
+        recycleCompletedSubmissions();
+
+        auto& recycler = device.getCommandRecycler();
+        auto submission = submissions.add(new Submission());
 
-        commandBuffer->begin();
-         commandsFunction(*commandBuffer);
-        commandBuffer->end();
+        submission->commandBuffer = recycler.getCommandBuffer();
 
-        auto signalSemaphore = semaphores.add(new VulkanSemaphore(device));
+        const auto& commandBuffer = *submission->commandBuffer;
 
-        submit(*commandBuffer, currentWaitSemaphore, signalSemaphore, useFence);
+        commandBuffer.begin();
+         commandsFunction(commandBuffer);
+        commandBuffer.end();
+
+        // The timeline orders the submits, a binary wait semaphore is consumed by the first one
+        if (timeline != nullptr)
+        {
+            submit(*submission, currentWaitSemaphore, useFence);
+            currentWaitSemaphore = nullptr;
+            return;
+        }
+
+        submission->signalSemaphore = recycler.getSemaphore();
+
+        submit(*submission, currentWaitSemaphore, useFence);
 
         // Current signal semaphore is the next wait semaphore !
-        currentWaitSemaphore = signalSemaphore;
+        currentWaitSemaphore = submission->signalSemaphore.get();
     }
 
+    /** The number of submits that still hold a command buffer or semaphore. */
+    int getNumPendingSubmissions() const noexcept { return submissions.size(); }
+
     void waitForFence(juce::RelativeTime duration = juce::RelativeTime::milliseconds(10)) noexcept
     {
+        if (useSubmitBatch)
+        {
+            if (auto* batch = submitBatch.get())
+                batch->waitIdle(batchGeneration);
+
+            return;
+        }
+
+        if (timeline != nullptr)
+        {
+            if (timelineValue > 0)
+                timeline->waitIdle(timelineValue, duration);
+
+            return;
+        }
+
         if (! fenceInUseFlag)
             return;
             
@@ -128,8 +212,83 @@ public:
     }
 
 private:
-    void submit(const VulkanCommandBuffer& commandBuffer, const VulkanSemaphore* waitSemaphore, const VulkanSemaphore* signalSemaphore, bool useFence)
+    struct Submission
+    {
+        std::unique_ptr<VulkanCommandBuffer> commandBuffer;
+        std::unique_ptr<VulkanSemaphore> signalSemaphore;
+
+        uint64_t batchGeneration = 0;
+        uint64_t timelineValue = 0;
+    };
+
+    bool isSubmissionCompleted(const Submission& submission, int index) noexcept
     {
+        if (useSubmitBatch)
+        {
+            auto* batch = submitBatch.get();
+            return batch == nullptr || batch->isCompleted(submission.batchGeneration);
+        }
+
+        if (timeline != nullptr)
+            return timeline->isCompleted(submission.timelineValue);
+
+        // Only the fenced submits are tracked, the fence covers all submits before
+        if (index >= numFencedSubmissions)
+            return false;
+
+        if (fenceInUseFlag && completedFence.isSignaled())
+            fenceInUseFlag = false;
+
+        return ! fenceInUseFlag;
+    }
+
+    /** Recycle the command buffers of completed submits. The signal semaphore of a submit is 
+        unsignaled once the next submit, which waits on it, has completed as well. */
+    void recycleCompletedSubmissions()
+    {
+        auto& recycler = device.getCommandRecycler();
+
+        int numCompleted = 0;
+        while (numCompleted < submissions.size() && isSubmissionCompleted(*submissions.getUnchecked(numCompleted), numCompleted))
+            ++numCompleted;
+
+        for (int i = 0; i < numCompleted; ++i)
+            recycler.recycle(std::move(submissions.getUnchecked(i)->commandBuffer));
+
+        const auto numRemoved = juce::jmax(0, numCompleted - 1);
+
+        for (int i = 0; i < numRemoved; ++i)
+            recycler.recycle(std::move(submissions.getUnchecked(i)->signalSemaphore));
+
+        submissions.removeRange(0, numRemoved);
+        numFencedSubmissions = juce::jmax(0, numFencedSubmissions - numRemoved);
+    }
+
+    void submit(Submission& submission, const VulkanSemaphore* waitSemaphore, bool useFence)
+    {
+        const auto& commandBuffer = *submission.commandBuffer;
+        const auto* signalSemaphore = submission.signalSemaphore.get();
+
+        if (useSubmitBatch)
+        {
+            if (auto* batch = submitBatch.get())
+            {
+                batchGeneration = batch->add(commandBuffer, waitSemaphore, signalSemaphore);
+                submission.batchGeneration = batchGeneration;
+                return;
+            }
+
+            // The batch was destroyed after its submits had completed
+            useSubmitBatch = false;
+        }
+
+        if (timeline != nullptr)
+        {
+            submitTimeline(commandBuffer, waitSemaphore);
+            submission.timelineValue = timelineValue;
+            return;
+        }
+
         const auto& queue = device.getGraphicsQueue();
 
         auto submitInfo = SingleWaitSignalSubmit(commandBuffer);
@@ -149,15 +308,64 @@ private:
         queue.submit(submitInfo, useFence ? completedFence.getHandle() : nullptr);
 
         if (useFence)
+        {
             fenceInUseFlag = true;
+            numFencedSubmissions = submissions.size();
+        }
+    }
+
+    void submitTimeline(const VulkanCommandBuffer& commandBuffer, const VulkanSemaphore* waitSemaphore)
+    {
+        std::array<vk::Semaphore, 2> waitSemaphores;
+        std::array<uint64_t, 2> waitValues {};
+        std::array<vk::PipelineStageFlags, 2> waitStages;
+        uint32_t numWaits = 0;
+
+        if (waitSemaphore != nullptr)
+        {
+            waitSemaphores[numWaits] = waitSemaphore->getHandle();
+            waitStages[numWaits++] = vk::PipelineStageFlagBits::eColorAttachmentOutput;
+        }
+
+        if (timelineValue > 0)
+        {
+            waitSemaphores[numWaits] = timeline->getSemaphore().getHandle();
+            waitValues[numWaits] = timelineValue;
+            waitStages[numWaits++] = vk::PipelineStageFlagBits::eAllCommands;
+        }
+
+        const auto signalValue = timeline->getNextValue();
+
+        const auto timelineInfo = vk::TimelineSemaphoreSubmitInfo()
+            .setWaitSemaphoreValueCount(numWaits)
+            .setPWaitSemaphoreValues(waitValues.data())
+            .setSignalSemaphoreValueCount(1)
+            .setPSignalSemaphoreValues(&signalValue);
+
+        const auto commandBufferHandle = commandBuffer.getHandle();
+
+        const auto submitInfo = vk::SubmitInfo()
+            .setPNext(&timelineInfo)
+            .setWaitSemaphoreCount(numWaits)
+            .setPWaitSemaphores(waitSemaphores.data())
+            .setPWaitDstStageMask(waitStages.data())
+            .setCommandBufferCount(1)
+            .setPCommandBuffers(&commandBufferHandle)
+            .setSignalSemaphoreCount(1)
+            .setPSignalSemaphores(&timeline->getSemaphore().getHandle());
+
+        if (device.getGraphicsQueue().submit(submitInfo) == vk::Result::eSuccess)
+            timelineValue = signalValue;
     }
 
 protected:
     const VulkanDevice& device;
 
 private:
-    juce::OwnedArray<VulkanCommandBuffer> commandBuffers;
-    juce::OwnedArray<VulkanSemaphore> semaphores;
+    VulkanTimeline* const timeline;
+
+    juce::OwnedArray<Submission> submissions;
+    int numFencedSubmissions = 0;
    
     const VulkanSemaphore* currentWaitSemaphore = nullptr;
 
@@ -165,6 +373,12 @@ private:
 
     bool fenceInUseFlag = false;
 
+    uint64_t timelineValue = 0;
+
+    juce::WeakReference<VulkanSubmitBatch> submitBatch;
+    bool useSubmitBatch = false;
+    uint64_t batchGeneration = 0;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VulkanCommandSequence)
 };
     
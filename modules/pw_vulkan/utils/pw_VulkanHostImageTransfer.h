@@ -0,0 +1,104 @@
+/*
+  ==============================================================================
+
+   This file is part of the Parawave Vulkan C++ library.
+
+   The code included in this file is provided under the terms of the ISC license
+   https://opensource.org/licenses/ISC.
+
+   Copyright (c) 2021 - Parawave Audio (https://parawave-audio.com/vulkan-cpp-library)
+
+   Permission to use, copy, modify, and/or distribute this software for any 
+   purpose with or without fee is hereby granted, provided that the above 
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES 
+   WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF 
+   MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+   SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES 
+   WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+   OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN 
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace parawave
+{
+ 
+//==============================================================================
+/** 
+    VulkanHostImageTransfer
+    
+    Copy pixels from imported host memory into an image and transition it into a 
+    shader read only layout. Unlike VulkanImageTransfer there's no staging buffer, 
+    the device reads the rows straight out of the application's bitmap.
+
+    The pixels must stay unchanged until the completed fence is signaled.
+*/
+class VulkanHostImageTransfer : public VulkanCommandSequence
+{
+public:
+    VulkanHostImageTransfer(const VulkanDevice& device_, const VulkanImage& image_, const VulkanHostMemoryBuffer& hostMemory_) :
+        VulkanCommandSequence(device_), image(image_), hostMemory(hostMemory_)
+    { 
+        // Only B G R A, 8 bit per pixel data can be copied without conversion
+        jassert(image.getFormat() == vk::Format::eB8G8R8A8Unorm);
+        jassert(hostMemory.isValid());
+    }
+
+    ~VulkanHostImageTransfer() override = default;
+
+    /** True if the bitmap can be copied as it is. The pixels must be premultiplied ARGB, 
+        which is stored as B G R A on little endian machines, and inside of the imported memory. */
+    static bool canCopyBitmapData(const VulkanHostMemoryBuffer& hostMemory, const juce::Image::BitmapData& bitmapData) noexcept
+    {
+       #if JUCE_BIG_ENDIAN
+        juce::ignoreUnused(hostMemory, bitmapData);
+        return false;
+       #else
+        const auto dataSize = static_cast<vk::DeviceSize>(bitmapData.lineStride) * static_cast<vk::DeviceSize>(bitmapData.height);
+
+        return hostMemory.isValid()
+            && bitmapData.pixelFormat == juce::Image::ARGB 
+            && bitmapData.pixelStride == 4 
+            && (bitmapData.lineStride % 4) == 0
+            && hostMemory.contains(bitmapData.data, dataSize)
+            && (hostMemory.getOffset(bitmapData.data) % 4) == 0;
+       #endif
+    }
+
+    /** Copy the bitmap rows from the imported memory into the image. */
+    void copyBitmapData(const juce::Image::BitmapData& bitmapData)
+    {
+        jassert(canCopyBitmapData(hostMemory, bitmapData));
+
+        auto region = VulkanImageTransfer::CopyRegion(image);
+        region.setBufferOffset(hostMemory.getOffset(bitmapData.data));
+        region.setBufferRowLength(static_cast<uint32_t>(bitmapData.lineStride / bitmapData.pixelStride));
+        region.setImageExtent(vk::Extent3D(static_cast<uint32_t>(bitmapData.width), static_cast<uint32_t>(bitmapData.height), 1));
+
+        copyBufferToImage(region);
+    }
+
+    void copyBufferToImage(const vk::BufferImageCopy& region)
+    {
+        submit([&](const VulkanCommandBuffer& cb)
+        {
+            cb.transitionImageLayout(image, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal);
+            cb.copyBufferToImage(image, hostMemory.getBuffer(), region);
+            cb.transitionImageLayout(image, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
+        }, true);
+    }
+
+private:
+    const VulkanImage& image;
+    const VulkanHostMemoryBuffer& hostMemory;
+
+private:
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VulkanHostImageTransfer)
+};
+
+} // namespace parawave
@@ -68,12 +68,31 @@ public:
 
     ~VulkanImageTransfer() override = default;
 
+    /** Read pixels from the host visible staging buffer, after the copy into the buffer has completed. */
     void readPixels(void* dataDst, vk::DeviceSize dataDstSize) const
     {
-        const auto copySize = std::min(stagingMemory.getMemorySize(), dataDstSize);
+        const auto copySize = std::min(stagingMemory.getSize(), dataDstSize);
+
+        stagingMemory.invalidate(0, copySize);
         std::memcpy(dataDst, stagingMemory.getData(), static_cast<size_t>(copySize));
     }
 
+    /** Read tightly packed rows from the staging buffer in reverse order. Flipping while copying 
+        avoids a second pass over the destination. */
+    void readPixelsFlipped(void* dataDst, size_t dataDstLineStride, size_t rowSize, int numRows) const
+    {
+        const auto copySize = static_cast<vk::DeviceSize>(rowSize * static_cast<size_t>(numRows));
+        jassert(copySize <= stagingMemory.getSize());
+
+        stagingMemory.invalidate(0, copySize);
+
+        const auto* src = static_cast<const uint8_t*>(stagingMemory.getData());
+        auto* dst = static_cast<uint8_t*>(dataDst);
+
+        for (int y = 0; y < numRows; ++y)
+            std::memcpy(dst + dataDstLineStride * static_cast<size_t>(numRows - 1 - y), src + rowSize * static_cast<size_t>(y), rowSize);
+    }
+
     /** Write BGRA pixels into the host visible staging buffer. */
     void writePixels(const void* dataSrc, vk::DeviceSize dataSrcSize) const
     {
@@ -143,7 +162,7 @@ public:
         submit([&](const VulkanCommandBuffer& cb)
         {
             cb.transitionImageLayout(image, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal);
-            cb.copyBufferToImage(image, stagingMemory.getBuffer(), region);
+            cb.copyBufferToImage(image, stagingMemory, region);
             cb.transitionImageLayout(image, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
         }, true);
     }
@@ -159,7 +178,7 @@ public:
         submit([&](const VulkanCommandBuffer& cb)
         {
             cb.transitionImageLayout(image, vk::ImageLayout::eShaderReadOnlyOptimal, vk::ImageLayout::eTransferSrcOptimal);
-            cb.copyImageToBuffer(stagingMemory.getBuffer(), image, region);
+            cb.copyImageToBuffer(stagingMemory, image, region);
             cb.transitionImageLayout(image, vk::ImageLayout::eTransferSrcOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
         }, true);
     }
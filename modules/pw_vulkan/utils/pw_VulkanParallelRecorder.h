@@ -0,0 +1,247 @@
+/*
+  ==============================================================================
+
+   This file is part of the Parawave Vulkan C++ library.
+
+   The code included in this file is provided under the terms of the ISC license
+   https://opensource.org/licenses/ISC.
+
+   Copyright (c) 2021 - Parawave Audio (https://parawave-audio.com/vulkan-cpp-library)
+
+   Permission to use, copy, modify, and/or distribute this software for any 
+   purpose with or without fee is hereby granted, provided that the above 
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES 
+   WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF 
+   MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+   SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES 
+   WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+   OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN 
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+  ==============================================================================
+*/
+
+
+#pragma once
+
+namespace parawave
+{
+
+//==============================================================================
+/** 
+    VulkanParallelRecorder
+
+    Records independent parts of a render pass on several threads. Each record 
+    function is recorded into a secondary command buffer, which continues the 
+    subpass of the render pass, and the primary command buffer executes them in 
+    the order of the functions.
+
+    The worker threads and the calling thread take the next function from a shared 
+    index as soon as they're done with the previous one, so a few expensive parts 
+    don't stall the others. Command pools are externally synchronized, so every 
+    thread allocates its secondary command buffers from its own transient pool.
+
+    The functions run concurrently, they must only access state that is safe to 
+    use from several threads and must not share command buffers or pools.
+
+    Several recorders, e.g. one per frame in flight, can share the threads of one 
+    juce::ThreadPool. record() blocks until its jobs are done, so the recorders 
+    don't interfere as long as they're used from the same thread.
+
+    @code
+    recorder.reset(); // after the commands of the last frame have completed
+
+    recorder.record(renderPass, &framebuffer, functions);
+
+    primary.beginRenderPass(renderPass, framebuffer, area, vk::SubpassContents::eSecondaryCommandBuffers);
+    recorder.execute(primary);
+    primary.endRenderPass();
+    @endcode
+*/
+class VulkanParallelRecorder final
+{
+public:
+    using RecordFunction = std::function<void(const VulkanCommandBuffer& commandBuffer)>;
+
+private:
+    VulkanParallelRecorder() = delete;
+
+public:
+    VulkanParallelRecorder(const VulkanDevice& device_, int numThreads = juce::jmax(1, juce::SystemStats::getNumCpus() - 1)) :
+        device(device_), ownedThreadPool(std::make_unique<juce::ThreadPool>(numThreads)), threadPool(*ownedThreadPool)
+    {
+        jassert(numThreads > 0);
+        createSlots();
+    }
+
+    VulkanParallelRecorder(const VulkanDevice& device_, juce::ThreadPool& sharedThreadPool) :
+        device(device_), threadPool(sharedThreadPool)
+    {
+        createSlots();
+    }
+
+    ~VulkanParallelRecorder()
+    {
+        if (ownedThreadPool != nullptr)
+            ownedThreadPool->removeAllJobs(true, 10000);
+    }
+
+    int getNumThreads() const noexcept { return threadPool.getNumThreads(); }
+
+    /** Reset the command pools of all threads, so the memory of the command buffers is reused. 
+        Only call it, once the commands of the last execute() have completed. */
+    void reset()
+    {
+        for (auto slot : slots)
+            slot->reset();
+
+        recorded.clearQuick();
+    }
+
+    /** Record each function into its own secondary command buffer. Blocks until all are recorded. */
+    void record(const VulkanRenderPass& renderPass, const VulkanFramebuffer* framebuffer, const juce::Array<RecordFunction>& functions)
+    {
+        const auto numFunctions = functions.size();
+        if (numFunctions == 0)
+            return;
+
+        const auto firstIndex = recorded.size();
+        recorded.insertMultiple(firstIndex, nullptr, numFunctions);
+
+        currentRenderPass = &renderPass;
+        currentFramebuffer = framebuffer;
+        currentFunctions = &functions;
+        currentFirstIndex = firstIndex;
+
+        nextFunction = 0;
+
+        // Don't wake up more threads than there are functions for
+        const auto numJobs = juce::jmin(getNumThreads(), numFunctions - 1);
+        remainingJobs = numJobs;
+        jobsFinished.reset();
+
+        for (int i = 0; i < numJobs; ++i)
+            threadPool.addJob(new RecordJob(*this, *slots.getUnchecked(i)), true);
+
+        recordFunctions(*slots.getLast());
+
+        if (numJobs > 0)
+            jobsFinished.wait();
+
+        currentFunctions = nullptr;
+    }
+
+    /** Execute all recorded command buffers since the last reset(). The primary command buffer 
+        must be inside of the render pass, begun with vk::SubpassContents::eSecondaryCommandBuffers. */
+    void execute(const VulkanCommandBuffer& primaryCommandBuffer) const noexcept
+    {
+        primaryCommandBuffer.executeCommands(recorded);
+    }
+
+    int getNumRecorded() const noexcept { return recorded.size(); }
+
+private:
+    /** The command pool and the secondary command buffers of one thread. */
+    struct ThreadSlot
+    {
+        ThreadSlot(const VulkanDevice& device_) : 
+            device(device_), commandPool(device_, device_.getGraphicsQueue().familyIndex, vk::CommandPoolCreateFlagBits::eTransient) {}
+
+        const VulkanCommandBuffer& getNextCommandBuffer()
+        {
+            if (numUsed == commandBuffers.size())
+                commandBuffers.add(new VulkanCommandBuffer(device, commandPool, vk::CommandBufferLevel::eSecondary));
+
+            return *commandBuffers.getUnchecked(numUsed++);
+        }
+
+        void reset()
+        {
+            if (numUsed > 0)
+                commandPool.reset();
+
+            numUsed = 0;
+        }
+
+        const VulkanDevice& device;
+        const VulkanCommandPool commandPool;
+
+        juce::OwnedArray<VulkanCommandBuffer> commandBuffers;
+        int numUsed = 0;
+    };
+
+    void createSlots()
+    {
+        // One more slot for the calling thread
+        for (int i = 0; i <= threadPool.getNumThreads(); ++i)
+            slots.add(new ThreadSlot(device));
+    }
+
+    //==============================================================================
+    class RecordJob final : public juce::ThreadPoolJob
+    {
+    public:
+        RecordJob(VulkanParallelRecorder& owner_, ThreadSlot& slot_) : 
+            juce::ThreadPoolJob("Vulkan Command Recording"), owner(owner_), slot(slot_) {}
+
+        JobStatus runJob() override
+        {
+            owner.recordFunctions(slot);
+
+            if (--owner.remainingJobs == 0)
+                owner.jobsFinished.signal();
+
+            return jobHasFinished;
+        }
+
+    private:
+        VulkanParallelRecorder& owner;
+        ThreadSlot& slot;
+    };
+
+    void recordFunctions(ThreadSlot& slot)
+    {
+        const auto& functions = *currentFunctions;
+
+        for (;;)
+        {
+            const auto index = nextFunction++;
+            if (index >= functions.size())
+                break;
+
+            const auto& commandBuffer = slot.getNextCommandBuffer();
+
+            commandBuffer.beginSecondary(*currentRenderPass, currentFramebuffer);
+             functions.getReference(index)(commandBuffer);
+            commandBuffer.end();
+
+            // Every index is written by one thread only, the array isn't resized while recording
+            recorded.setUnchecked(currentFirstIndex + index, &commandBuffer);
+        }
+    }
+
+private:
+    const VulkanDevice& device;
+
+    std::unique_ptr<juce::ThreadPool> ownedThreadPool;
+    juce::ThreadPool& threadPool;
+
+    juce::OwnedArray<ThreadSlot> slots;
+
+    juce::Array<const VulkanCommandBuffer*> recorded;
+
+    const VulkanRenderPass* currentRenderPass = nullptr;
+    const VulkanFramebuffer* currentFramebuffer = nullptr;
+    const juce::Array<RecordFunction>* currentFunctions = nullptr;
+    int currentFirstIndex = 0;
+
+    std::atomic<int> nextFunction { 0 };
+    std::atomic<int> remainingJobs { 0 };
+    juce::WaitableEvent jobsFinished;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VulkanParallelRecorder)
+};
+
+} // namespace parawave
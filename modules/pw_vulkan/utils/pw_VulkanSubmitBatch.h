@@ -0,0 +1,383 @@
+/*
+  ==============================================================================
+
+   This file is part of the Parawave Vulkan C++ library.
+
+   The code included in this file is provided under the terms of the ISC license
+   https://opensource.org/licenses/ISC.
+
+   Copyright (c) 2021 - Parawave Audio (https://parawave-audio.com/vulkan-cpp-library)
+
+   Permission to use, copy, modify, and/or distribute this software for any 
+   purpose with or without fee is hereby granted, provided that the above 
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES 
+   WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF 
+   MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+   SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES 
+   WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+   OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN 
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace parawave
+{
+
+//==============================================================================
+/** 
+    VulkanSubmitBatch
+
+    Collects the command buffers of a frame, with their wait and signal semaphores, 
+    and submits all of them with a single vkQueueSubmit and one fence. Every call 
+    to vkQueueSubmit has a considerable overhead in the driver, so a frame with 
+    many passes and transfers is much cheaper to submit in one go.
+
+    The command buffers are submitted in the order they were added, which must be 
+    the order of their dependencies. Semaphores between entries of the same batch 
+    are valid, since the signal is submitted before the wait.
+
+    Each fenced submit increases the generation of the batch. add() returns the 
+    generation that will include the commands, which can be passed to isCompleted().
+    A fence covers every command submitted before it, so entries that were submitted 
+    early with submit(false) complete with the next fenced submit.
+
+    If the device has a timeline, the entries signal consecutive timeline values and 
+    each entry waits for the one before, instead of using the fence. Binary semaphores 
+    that are signaled and waited inside the same submit are replaced by these waits, 
+    so only the semaphores shared with the swapchain remain.
+
+    The command sequences added to the batch only keep a weak reference to it. The 
+    batch waits for its last fenced submit when it's destroyed, so a sequence can 
+    treat its commands as completed once the batch is gone.
+*/
+class VulkanSubmitBatch final
+{
+private:
+    VulkanSubmitBatch() = delete;
+
+public:
+    explicit VulkanSubmitBatch(const VulkanDevice& device_) : 
+        device(device_), timeline(device_.getTimeline()), completedFence(device_) {}
+
+    ~VulkanSubmitBatch()
+    {
+        waitIdle();
+    }
+
+    const VulkanFence& getCompletedFence() const noexcept { return completedFence; }
+
+    /** The timeline that tracks the submits, nullptr if the fence is used instead. */
+    VulkanTimeline* getTimeline() const noexcept { return timeline; }
+
+    bool isEmpty() const noexcept { return entries.isEmpty(); }
+
+    int getNumEntries() const noexcept { return entries.size(); }
+
+    /** Add a command buffer, which is executed after all previously added command buffers 
+        were submitted. Returns the generation of the fenced submit that will include it. */
+    uint64_t add(const VulkanCommandBuffer& commandBuffer, const VulkanSemaphore* waitSemaphore = nullptr, const VulkanSemaphore* signalSemaphore = nullptr,
+        vk::PipelineStageFlags waitStage = vk::PipelineStageFlagBits::eColorAttachmentOutput)
+    {
+        Entry entry;
+
+        entry.commandBuffer = commandBuffer.getHandle();
+        entry.waitSemaphore = waitSemaphore != nullptr ? waitSemaphore->getHandle() : vk::Semaphore();
+        entry.signalSemaphore = signalSemaphore != nullptr ? signalSemaphore->getHandle() : vk::Semaphore();
+        entry.waitStage = waitStage;
+
+        entries.add(entry);
+
+        return submittedGeneration + 1;
+    }
+
+    /** Submit all added command buffers in one vkQueueSubmit. If signalFence is true, the 
+        completed fence is signaled after the commands and the generation is increased. 
+        Without a timeline, it waits for the previous fenced submit to complete, before the 
+        fence is reused. If that times out, the command buffers are still submitted, but 
+        without the fence, and eTimeout is returned. They complete with the next fenced 
+        submit and are never submitted twice. */
+    vk::Result submit(bool signalFence = true)
+    {
+        if (! waitForPreviousSubmit(signalFence))
+        {
+            const auto result = submitEntries(false);
+            return result == vk::Result::eSuccess ? vk::Result::eTimeout : result;
+        }
+
+        return submitEntries(signalFence);
+    }
+
+    /** True if the fenced submit of the generation has completed. */
+    bool isCompleted(uint64_t generation) noexcept
+    {
+        if (generation <= completedGeneration)
+            return true;
+
+        if (generation <= submittedGeneration && fencePending && isPendingSubmitCompleted())
+            setCompleted();
+
+        return generation <= completedGeneration;
+    }
+
+    /** Wait for the last fenced submit. Returns false if it didn't complete in time. */
+    bool waitForCompletion(juce::RelativeTime duration = juce::RelativeTime::seconds(1.0)) noexcept
+    {
+        if (fencePending)
+        {
+            const auto completed = timeline != nullptr ? timeline->wait(pendingValue, duration) 
+                                                       : completedFence.wait(duration);
+            if (! completed)
+                return false;
+
+            setCompleted();
+        }
+
+        return true;
+    }
+
+    /** Block until the last fenced submit has completed. Returns false if the wait failed 
+        with an error, e.g. because the device was lost, which a retry can't fix. */
+    bool waitIdle() noexcept
+    {
+        if (! fencePending)
+            return true;
+
+        const auto completed = timeline != nullptr ? timeline->waitIdle(pendingValue) 
+                                                   : completedFence.waitIdle();
+        if (completed)
+            setCompleted();
+
+        return completed;
+    }
+
+    /** Block until the commands of the generation have completed. If they weren't submitted 
+        yet, the batch is submitted with the fence first. */
+    bool waitIdle(uint64_t generation)
+    {
+        if (generation > submittedGeneration && submit(true) != vk::Result::eSuccess)
+            return false;
+
+        if (generation > completedGeneration)
+            return waitIdle();
+
+        return true;
+    }
+
+private:
+    struct Entry
+    {
+        vk::CommandBuffer commandBuffer;
+        vk::Semaphore waitSemaphore;
+        vk::Semaphore signalSemaphore;
+        vk::PipelineStageFlags waitStage;
+    };
+
+    /** The semaphores and values of an entry, which are referenced by its submit info. */
+    struct TimelineSubmit
+    {
+        std::array<vk::Semaphore, 2> waitSemaphores;
+        std::array<uint64_t, 2> waitValues {};
+        std::array<vk::PipelineStageFlags, 2> waitStages;
+
+        std::array<vk::Semaphore, 2> signalSemaphores;
+        std::array<uint64_t, 2> signalValues {};
+
+        vk::TimelineSemaphoreSubmitInfo timelineInfo;
+    };
+
+    /** The entries are cleared, even if the submit fails, so they're never submitted twice. */
+    vk::Result submitEntries(bool signalFence)
+    {
+        if (entries.isEmpty() && ! signalFence)
+            return vk::Result::eSuccess;
+
+        submitInfos.clearQuick();
+        submitInfos.ensureStorageAllocated(entries.size());
+
+        uint64_t signaledValue = 0;
+
+        if (timeline != nullptr)
+            signaledValue = addTimelineSubmitInfos();
+        else
+            addSubmitInfos();
+
+        const auto fence = (signalFence && timeline == nullptr) ? completedFence.getHandle() : vk::Fence();
+        const auto result = device.getGraphicsQueue().submit(static_cast<uint32_t>(submitInfos.size()), submitInfos.getRawDataPointer(), fence);
+
+        entries.clearQuick();
+
+        if (result == vk::Result::eSuccess)
+        {
+            if (timeline != nullptr)
+                lastSignaledValue = signaledValue;
+
+            if (signalFence)
+            {
+                ++submittedGeneration;
+                pendingValue = lastSignaledValue;
+                fencePending = true;
+            }
+        }
+
+        return result;
+    }
+
+    bool waitForPreviousSubmit(bool signalFence) noexcept
+    {
+        // The timeline doesn't have to be reset, so the commands can be submitted while the previous frame is in flight
+        if (! signalFence || timeline != nullptr)
+            return true;
+
+        if (! waitForCompletion())
+            return false;
+
+        return completedFence.reset();
+    }
+
+    bool isPendingSubmitCompleted() const noexcept
+    {
+        return timeline != nullptr ? timeline->isCompleted(pendingValue) : completedFence.isSignaled();
+    }
+
+    void addSubmitInfos()
+    {
+        for (const auto& entry : entries)
+        {
+            auto submitInfo = vk::SubmitInfo()
+                .setCommandBufferCount(1)
+                .setPCommandBuffers(&entry.commandBuffer);
+
+            if (entry.waitSemaphore)
+                submitInfo.setWaitSemaphoreCount(1).setPWaitSemaphores(&entry.waitSemaphore).setPWaitDstStageMask(&entry.waitStage);
+
+            if (entry.signalSemaphore)
+                submitInfo.setSignalSemaphoreCount(1).setPSignalSemaphores(&entry.signalSemaphore);
+
+            submitInfos.add(submitInfo);
+        }
+    }
+
+    bool isSignaledInSubmit(vk::Semaphore semaphore, int entryIndex) const noexcept
+    {
+        for (int i = 0; i < entryIndex; ++i)
+            if (entries.getReference(i).signalSemaphore == semaphore)
+                return true;
+
+        return false;
+    }
+
+    bool isWaitedInSubmit(vk::Semaphore semaphore, int entryIndex) const noexcept
+    {
+        for (int i = entryIndex + 1; i < entries.size(); ++i)
+            if (entries.getReference(i).waitSemaphore == semaphore)
+                return true;
+
+        return false;
+    }
+
+    /** Returns the timeline value of the last submit info. */
+    uint64_t addTimelineSubmitInfos()
+    {
+        const auto timelineSemaphore = timeline->getSemaphore().getHandle();
+
+        // A fenced submit without entries still needs a submit to signal its value
+        const auto numSubmits = juce::jmax(1, entries.size());
+
+        timelineSubmits.clearQuick();
+        timelineSubmits.insertMultiple(0, TimelineSubmit(), numSubmits);
+
+        auto previousValue = timeline->isCompleted(lastSignaledValue) ? 0 : lastSignaledValue;
+        auto value = timeline->getNextValues(static_cast<uint64_t>(numSubmits));
+
+        for (int i = 0; i < numSubmits; ++i, ++value)
+        {
+            auto& timelineSubmit = timelineSubmits.getReference(i);
+            auto submitInfo = vk::SubmitInfo();
+
+            uint32_t numWaits = 0;
+            uint32_t numSignals = 0;
+
+            if (i < entries.size())
+            {
+                const auto& entry = entries.getReference(i);
+
+                submitInfo.setCommandBufferCount(1).setPCommandBuffers(&entry.commandBuffer);
+
+                // Binary semaphores between entries of this submit are covered by the timeline waits
+                if (entry.waitSemaphore && ! isSignaledInSubmit(entry.waitSemaphore, i))
+                {
+                    timelineSubmit.waitSemaphores[numWaits] = entry.waitSemaphore;
+                    timelineSubmit.waitStages[numWaits++] = entry.waitStage;
+                }
+
+                if (entry.signalSemaphore && ! isWaitedInSubmit(entry.signalSemaphore, i))
+                    timelineSubmit.signalSemaphores[numSignals++] = entry.signalSemaphore;
+            }
+
+            if (previousValue > 0)
+            {
+                timelineSubmit.waitSemaphores[numWaits] = timelineSemaphore;
+                timelineSubmit.waitValues[numWaits] = previousValue;
+                timelineSubmit.waitStages[numWaits++] = vk::PipelineStageFlagBits::eAllCommands;
+            }
+
+            timelineSubmit.signalSemaphores[numSignals] = timelineSemaphore;
+            timelineSubmit.signalValues[numSignals++] = value;
+
+            timelineSubmit.timelineInfo
+                .setWaitSemaphoreValueCount(numWaits)
+                .setPWaitSemaphoreValues(timelineSubmit.waitValues.data())
+                .setSignalSemaphoreValueCount(numSignals)
+                .setPSignalSemaphoreValues(timelineSubmit.signalValues.data());
+
+            submitInfo
+                .setPNext(&timelineSubmit.timelineInfo)
+                .setWaitSemaphoreCount(numWaits)
+                .setPWaitSemaphores(timelineSubmit.waitSemaphores.data())
+                .setPWaitDstStageMask(timelineSubmit.waitStages.data())
+                .setSignalSemaphoreCount(numSignals)
+                .setPSignalSemaphores(timelineSubmit.signalSemaphores.data());
+
+            submitInfos.add(submitInfo);
+
+            previousValue = value;
+        }
+
+        return previousValue;
+    }
+
+    void setCompleted() noexcept
+    {
+        completedGeneration = submittedGeneration;
+        fencePending = false;
+    }
+
+private:
+    const VulkanDevice& device;
+
+    VulkanTimeline* const timeline;
+
+    const VulkanFence completedFence;
+
+    juce::Array<Entry> entries;
+    juce::Array<vk::SubmitInfo> submitInfos;
+    juce::Array<TimelineSubmit> timelineSubmits;
+
+    uint64_t submittedGeneration = 0;
+    uint64_t completedGeneration = 0;
+
+    uint64_t lastSignaledValue = 0;
+    uint64_t pendingValue = 0;
+
+    bool fencePending = false;
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE (VulkanSubmitBatch)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VulkanSubmitBatch)
+};
+
+} // namespace parawave
@@ -0,0 +1,153 @@
+/*
+  ==============================================================================
+
+   This file is part of the Parawave Vulkan C++ library.
+
+   The code included in this file is provided under the terms of the ISC license
+   https://opensource.org/licenses/ISC.
+
+   Copyright (c) 2021 - Parawave Audio (https://parawave-audio.com/vulkan-cpp-library)
+
+   Permission to use, copy, modify, and/or distribute this software for any 
+   purpose with or without fee is hereby granted, provided that the above 
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES 
+   WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF 
+   MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+   SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES 
+   WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+   OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN 
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+  ==============================================================================
+*/
+
+
+#pragma once
+
+namespace parawave
+{
+
+//==============================================================================
+/** 
+    VulkanTimeline
+
+    A timeline semaphore that counts the submissions to the graphics queue of a 
+    device. Every submit that should be tracked signals the next value, so the 
+    completion of any earlier submit is a comparison with the counter. Unlike a 
+    fence it never has to be reset, and one semaphore replaces the fences and 
+    chained binary semaphores of all submissions.
+
+    Values must be signaled in the order they were taken with getNextValue(), 
+    so take the value right before the submit, on the thread that submits.
+*/
+class VulkanTimeline final
+{
+private:
+    VulkanTimeline() = delete;
+
+public:
+    explicit VulkanTimeline(const VulkanDevice& device_) : 
+        device(device_), semaphore(device_, 0) {}
+
+    ~VulkanTimeline() = default;
+
+    const VulkanSemaphore& getSemaphore() const noexcept { return semaphore; }
+
+    /** Take the value for the next signal operation. */
+    uint64_t getNextValue() noexcept { return ++submittedValue; }
+
+    /** Take count consecutive values and return the first one. */
+    uint64_t getNextValues(uint64_t count) noexcept { return submittedValue.fetch_add(count) + 1; }
+
+    /** The last value that was taken for a signal operation. */
+    uint64_t getSubmittedValue() const noexcept { return submittedValue.load(); }
+
+    /** Query the counter of the semaphore. */
+    uint64_t getCompletedValue() const noexcept
+    {
+        const auto value = semaphore.getCounterValue();
+        setCompletedValue(value);
+
+        return value;
+    }
+
+    /** True if the signal operation of the value has completed. Only queries the counter, 
+        if the last known value is smaller. */
+    bool isCompleted(uint64_t value) const noexcept
+    {
+        return value <= completedValue.load() || value <= getCompletedValue();
+    }
+
+    /** Wait until the value is signaled. Returns false if it didn't complete in time. */
+    bool wait(uint64_t value, juce::RelativeTime duration = juce::RelativeTime::seconds(1.0)) const noexcept
+    {
+        return waitForResult(value, duration) == vk::Result::eSuccess;
+    }
+
+    /** Returns eSuccess, eTimeout or the error of the wait, e.g. eErrorDeviceLost. */
+    vk::Result waitForResult(uint64_t value, juce::RelativeTime duration = juce::RelativeTime::seconds(1.0)) const noexcept
+    {
+        if (value <= completedValue.load())
+            return vk::Result::eSuccess;
+
+        jassert(value <= getSubmittedValue()); // The value was never submitted, this would wait forever !
+
+        const auto result = semaphore.waitForResult(value, duration);
+
+        if (result == vk::Result::eSuccess)
+            setCompletedValue(value);
+
+        return result;
+    }
+
+    /** Idles in a sleep loop with the specified duration until the value is signaled. 
+        Returns false if the wait failed with an error, e.g. because the device was lost. */
+    bool waitIdle(uint64_t value, juce::RelativeTime duration = juce::RelativeTime::milliseconds(10)) const noexcept
+    {
+        const auto halfDuration = static_cast<int>(duration.seconds(duration.inSeconds() / 2.0).inMilliseconds());
+
+        for (;;)
+        {
+            const auto result = waitForResult(value, duration);
+
+            if (result != vk::Result::eTimeout)
+                return result == vk::Result::eSuccess;
+
+            juce::Thread::sleep(halfDuration);
+        }
+    }
+
+    /** Submit a signal operation of the next value, that completes after all commands 
+        submitted before. Returns the value or 0 if the submit failed. */
+    uint64_t signal()
+    {
+        const auto value = getNextValue();
+
+        if (device.getGraphicsQueue().signal(semaphore, value) != vk::Result::eSuccess)
+            return 0;
+
+        return value;
+    }
+
+private:
+    void setCompletedValue(uint64_t value) const noexcept
+    {
+        auto current = completedValue.load();
+
+        while (current < value && ! completedValue.compare_exchange_weak(current, value)) {}
+    }
+
+private:
+    const VulkanDevice& device;
+
+    const VulkanSemaphore semaphore;
+
+    std::atomic<uint64_t> submittedValue { 0 };
+    mutable std::atomic<uint64_t> completedValue { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VulkanTimeline)
+};
+
+} // namespace parawave
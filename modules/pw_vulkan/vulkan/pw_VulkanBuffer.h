@@ -44,12 +44,12 @@ private:
 
 public:
     VulkanBuffer(const VulkanDevice& device_, const vk::BufferCreateInfo& createInfo)
-        : device(device_), size(createInfo.size) 
+        : device(device_), size(createInfo.size), usage(createInfo.usage) 
     { 
         vk::Result result;
     
         jassert(device.getHandle());
-        std::tie(result, handle) = device.getHandle().createBufferUnique(createInfo).asTuple();
+        std::tie(result, handle) = device.getHandle().createBufferUnique(createInfo, device.getAllocationCallbacks()).asTuple();
 
         PW_CHECK_VK_RESULT_SUCCESS(result, "Couldn't create buffer.");
     }
@@ -63,6 +63,8 @@ public:
 
     vk::DeviceSize getSize() const noexcept { return size; }
 
+    vk::BufferUsageFlags getUsage() const noexcept { return usage; }
+
     vk::MemoryRequirements getMemoryRequirements() const noexcept
     {
         jassert(getHandle() && device.getHandle());
@@ -74,6 +76,7 @@ private:
 
     vk::UniqueBuffer handle;
     vk::DeviceSize size;
+    vk::BufferUsageFlags usage;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VulkanBuffer)
 };
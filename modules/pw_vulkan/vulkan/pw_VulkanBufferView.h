@@ -52,7 +52,7 @@ public:
         vk::Result result;
     
         jassert(device.getHandle());
-        std::tie(result, handle) = device.getHandle().createBufferViewUnique(createInfo).asTuple();
+        std::tie(result, handle) = device.getHandle().createBufferViewUnique(createInfo, device.getAllocationCallbacks()).asTuple();
 
         PW_CHECK_VK_RESULT_SUCCESS(result, "Couldn't create buffer view.");
     }
@@ -70,6 +70,14 @@ struct BarrierOptions
             srcStage = vk::PipelineStageFlagBits::eTransfer;
             dstStage = vk::PipelineStageFlagBits::eFragmentShader;
         }
+        else if (oldLayout == vk::ImageLayout::ePreinitialized && newLayout == vk::ImageLayout::eShaderReadOnlyOptimal)
+        {
+            srcAccessMask = vk::AccessFlagBits::eHostWrite;
+            dstAccessMask = vk::AccessFlagBits::eShaderRead;
+
+            srcStage = vk::PipelineStageFlagBits::eHost;
+            dstStage = vk::PipelineStageFlagBits::eFragmentShader;
+        }
         else 
         {
             PW_DBG_V("Unsupported layout transition!");
@@ -112,7 +120,29 @@ void VulkanCommandBuffer::end() const noexcept
     PW_CHECK_VK_RESULT_SUCCESS(result, "Failed Failed to end command buffer recording.");
 }
 
+void VulkanCommandBuffer::beginSecondary(const VulkanRenderPass& renderPass, const VulkanFramebuffer* framebuffer, uint32_t subpass) const noexcept
+{
+    const auto inheritanceInfo = vk::CommandBufferInheritanceInfo()
+        .setRenderPass(renderPass.getHandle())
+        .setSubpass(subpass)
+        .setFramebuffer(framebuffer != nullptr ? framebuffer->getHandle() : vk::Framebuffer());
+
+    const auto beginInfo = vk::CommandBufferBeginInfo()
+        .setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit | vk::CommandBufferUsageFlagBits::eRenderPassContinue)
+        .setPInheritanceInfo(&inheritanceInfo);
+
+    jassert(handle);
+    const auto result = handle->begin(beginInfo);
+
+    PW_CHECK_VK_RESULT_SUCCESS(result, "Failed to begin secondary command buffer recording.");
+}
+
 void VulkanCommandBuffer::beginRenderPass(const VulkanRenderPass& renderPass, const VulkanFramebuffer& framebuffer, const vk::Rect2D& renderArea, const juce::Colour& clearColour) const noexcept
+{
+    beginRenderPass(renderPass, framebuffer, renderArea, vk::SubpassContents::eInline, clearColour);
+}
+
+void VulkanCommandBuffer::beginRenderPass(const VulkanRenderPass& renderPass, const VulkanFramebuffer& framebuffer, const vk::Rect2D& renderArea, vk::SubpassContents contents, const juce::Colour& clearColour) const noexcept
 {
     auto clearValue = vk::ClearValue()
         .setColor(VulkanConversion::toClearColorValue(clearColour));
@@ -123,7 +153,7 @@ void VulkanCommandBuffer::beginRenderPass(const VulkanRenderPass& renderPass, co
         .setRenderArea(renderArea)
         .setClearValues(clearValue);
 
-    handle->beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
+    handle->beginRenderPass(renderPassInfo, contents);
 }
 
 void VulkanCommandBuffer::endRenderPass() const noexcept
@@ -153,6 +183,20 @@ void VulkanCommandBuffer::clearColour(const vk::Rect2D& clearArea, const juce::C
     handle->clearAttachments(clearAttachments, clearRects);
 }
 
+void VulkanCommandBuffer::executeCommands(const juce::Array<const VulkanCommandBuffer*>& secondaryCommandBuffers) const noexcept
+{
+    if (secondaryCommandBuffers.isEmpty())
+        return;
+
+    std::vector<vk::CommandBuffer> handles;
+    handles.reserve(static_cast<size_t>(secondaryCommandBuffers.size()));
+
+    for (auto secondaryCommandBuffer : secondaryCommandBuffers)
+        handles.push_back(secondaryCommandBuffer->getHandle());
+
+    handle->executeCommands(handles);
+}
+
 void VulkanCommandBuffer::setViewport(const vk::Viewport& viewport) const noexcept
 {
     handle->setViewport(0, 1, &viewport);
@@ -188,17 +232,27 @@ void VulkanCommandBuffer::bindDescriptorSet(const VulkanPipelineLayout& pipeline
     handle->bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipelineLayout.getHandle(), 0, 1, &descriptorSet.getHandle(), 0, nullptr);
 }
 
-void VulkanCommandBuffer::bindVertexBuffer(const VulkanBuffer& vertexBuffer) const noexcept
+void VulkanCommandBuffer::bindVertexBuffer(const VulkanBuffer& vertexBuffer, vk::DeviceSize offset) const noexcept
 {
     vk::Buffer vertexBuffers[] = { vertexBuffer.getHandle() };
-    vk::DeviceSize offsets[] = { 0 };
+    vk::DeviceSize offsets[] = { offset };
             
     handle->bindVertexBuffers(0, 1, vertexBuffers, offsets);
 }
 
-void VulkanCommandBuffer::bindIndexBuffer(const VulkanBuffer& indexBuffer, vk::IndexType indexType) const noexcept
+void VulkanCommandBuffer::bindIndexBuffer(const VulkanBuffer& indexBuffer, vk::IndexType indexType, vk::DeviceSize offset) const noexcept
+{
+    handle->bindIndexBuffer(indexBuffer.getHandle(), offset, indexType);
+}
+
+void VulkanCommandBuffer::bindVertexBuffer(const VulkanMemoryBuffer& vertexBuffer, vk::DeviceSize offset) const noexcept
 {
-    handle->bindIndexBuffer(indexBuffer.getHandle(), 0, indexType);
+    bindVertexBuffer(vertexBuffer.getBuffer(), vertexBuffer.getOffset() + offset);
+}
+
+void VulkanCommandBuffer::bindIndexBuffer(const VulkanMemoryBuffer& indexBuffer, vk::IndexType indexType) const noexcept
+{
+    bindIndexBuffer(indexBuffer.getBuffer(), indexType, indexBuffer.getOffset());
 }
 
 void VulkanCommandBuffer::pushConstants(const VulkanPipelineLayout& layout, const void* constantData, uint32_t dataSize, uint32_t dataOffset, vk::ShaderStageFlags stageFlags) const noexcept
@@ -252,6 +306,31 @@ void VulkanCommandBuffer::copyImageToBuffer(const VulkanBuffer& dest, const Vulk
     handle->copyImageToBuffer(src.getHandle(), srcImageLayout, dest.getHandle(), 1, &region);
 }
 
+void VulkanCommandBuffer::copyBuffer(const VulkanMemoryBuffer& dest, const VulkanMemoryBuffer& src, vk::BufferCopy region) const noexcept
+{
+    region.srcOffset += src.getOffset();
+    region.dstOffset += dest.getOffset();
+
+    copyBuffer(dest.getBuffer(), src.getBuffer(), region);
+}
+
+void VulkanCommandBuffer::copyBufferToImage(const VulkanImage& dest, const VulkanMemoryBuffer& src, vk::BufferImageCopy region, vk::ImageLayout dstImageLayout) const noexcept
+{
+    region.bufferOffset += src.getOffset();
+    copyBufferToImage(dest, src.getBuffer(), region, dstImageLayout);
+}
+
+void VulkanCommandBuffer::copyImageToBuffer(const VulkanMemoryBuffer& dest, const VulkanImage& src, vk::BufferImageCopy region, vk::ImageLayout srcImageLayout) const noexcept
+{
+    region.bufferOffset += dest.getOffset();
+    copyImageToBuffer(dest.getBuffer(), src, region, srcImageLayout);
+}
+
+void VulkanCommandBuffer::copyImage(const VulkanImage& dest, const VulkanImage& src, const vk::ImageCopy& region, vk::ImageLayout dstImageLayout, vk::ImageLayout srcImageLayout) const noexcept
+{
+    handle->copyImage(src.getHandle(), srcImageLayout, dest.getHandle(), dstImageLayout, 1, &region);
+}
+
 void VulkanCommandBuffer::transitionImageLayout(const VulkanImage& image, vk::ImageLayout oldLayout, vk::ImageLayout newLayout) const noexcept
 {
     const auto imageSubresource = vk::ImageSubresourceRange()
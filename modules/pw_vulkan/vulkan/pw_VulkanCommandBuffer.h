@@ -52,9 +52,9 @@ public:
             handle = std::move(resultValue.value[0]);
     }
     
-    VulkanCommandBuffer(const VulkanDevice& device, const VulkanCommandPool& commandPool)
+    VulkanCommandBuffer(const VulkanDevice& device, const VulkanCommandPool& commandPool, vk::CommandBufferLevel level = vk::CommandBufferLevel::ePrimary)
         : VulkanCommandBuffer(device, vk::CommandBufferAllocateInfo()
-        .setCommandPool(commandPool.getHandle()).setLevel(vk::CommandBufferLevel::ePrimary).setCommandBufferCount(1)) {}
+        .setCommandPool(commandPool.getHandle()).setLevel(level).setCommandBufferCount(1)) {}
 
     VulkanCommandBuffer(const VulkanDevice& device)
         : VulkanCommandBuffer(device, device.getGraphicsCommandPool()) {}
@@ -69,14 +69,25 @@ public:
 
     void end() const noexcept;
 
+    /** Begin a secondary command buffer, that continues the subpass of the render pass in the 
+        primary command buffer which executes it. The framebuffer is optional, but might allow 
+        the driver to optimize the commands. */
+    void beginSecondary(const VulkanRenderPass& renderPass, const VulkanFramebuffer* framebuffer = nullptr, uint32_t subpass = 0) const noexcept;
+
     //==============================================================================
 
     void beginRenderPass(const VulkanRenderPass& renderPass, const VulkanFramebuffer& framebuffer, const vk::Rect2D& renderArea, const juce::Colour& clearColour = juce::Colours::transparentBlack) const noexcept;
 
+    /** With vk::SubpassContents::eSecondaryCommandBuffers, the subpass can only contain executeCommands(). */
+    void beginRenderPass(const VulkanRenderPass& renderPass, const VulkanFramebuffer& framebuffer, const vk::Rect2D& renderArea, vk::SubpassContents contents, const juce::Colour& clearColour = juce::Colours::transparentBlack) const noexcept;
+
     void endRenderPass() const noexcept;
 
     void clearColour(const vk::Rect2D& clearArea, const juce::Colour& clearColour = juce::Colours::transparentBlack) const noexcept;
 
+    /** Execute secondary command buffers in the given order. */
+    void executeCommands(const juce::Array<const VulkanCommandBuffer*>& secondaryCommandBuffers) const noexcept;
+
     //==============================================================================
 
     void setViewport(const vk::Viewport& viewport) const noexcept;
@@ -95,9 +106,14 @@ public:
 
     void bindDescriptorSet(const VulkanPipelineLayout& pipelineLayout, const VulkanDescriptorSet& descriptorSet) const noexcept;
 
-    void bindVertexBuffer(const VulkanBuffer& vertexBuffer) const noexcept;
+    void bindVertexBuffer(const VulkanBuffer& vertexBuffer, vk::DeviceSize offset = 0) const noexcept;
+
+    void bindIndexBuffer(const VulkanBuffer& indexBuffer, vk::IndexType indexType = vk::IndexType::eUint16, vk::DeviceSize offset = 0) const noexcept;
+
+    /** Bind the view of a (possibly suballocated) memory buffer at its offset. */
+    void bindVertexBuffer(const VulkanMemoryBuffer& vertexBuffer, vk::DeviceSize offset = 0) const noexcept;
 
-    void bindIndexBuffer(const VulkanBuffer& indexBuffer, vk::IndexType indexType = vk::IndexType::eUint16) const noexcept;
+    void bindIndexBuffer(const VulkanMemoryBuffer& indexBuffer, vk::IndexType indexType = vk::IndexType::eUint16) const noexcept;
 
     //==============================================================================
     
@@ -125,6 +141,16 @@ public:
 
     void copyImageToBuffer(const VulkanBuffer& dest, const VulkanImage& src, const vk::BufferImageCopy& region, vk::ImageLayout srcImageLayout = vk::ImageLayout::eTransferSrcOptimal) const noexcept;
 
+    /** The offsets of the region are relative to the views of the memory buffers. */
+    void copyBuffer(const VulkanMemoryBuffer& dest, const VulkanMemoryBuffer& src, vk::BufferCopy region) const noexcept;
+
+    void copyBufferToImage(const VulkanImage& dest, const VulkanMemoryBuffer& src, vk::BufferImageCopy region, vk::ImageLayout dstImageLayout = vk::ImageLayout::eTransferDstOptimal) const noexcept;
+
+    void copyImageToBuffer(const VulkanMemoryBuffer& dest, const VulkanImage& src, vk::BufferImageCopy region, vk::ImageLayout srcImageLayout = vk::ImageLayout::eTransferSrcOptimal) const noexcept;
+
+    void copyImage(const VulkanImage& dest, const VulkanImage& src, const vk::ImageCopy& region, 
+        vk::ImageLayout dstImageLayout = vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout srcImageLayout = vk::ImageLayout::eTransferSrcOptimal) const noexcept;
+
     void transitionImageLayout(const VulkanImage& image, vk::ImageLayout oldLayout, vk::ImageLayout newLayout) const noexcept;
 
     //==============================================================================
@@ -46,12 +46,12 @@ private:
     VulkanCommandPool() = delete;
 
 public:
-    VulkanCommandPool(const VulkanDevice& device, const vk::CommandPoolCreateInfo& createInfo)
+    VulkanCommandPool(const VulkanDevice& device_, const vk::CommandPoolCreateInfo& createInfo) : device(device_)
     {
         vk::Result result;
 
         jassert(device.getHandle());
-        std::tie(result, handle) = device.getHandle().createCommandPoolUnique(createInfo).asTuple();
+        std::tie(result, handle) = device.getHandle().createCommandPoolUnique(createInfo, device.getAllocationCallbacks()).asTuple();
 
         PW_CHECK_VK_RESULT_SUCCESS(result, "Couldn't create command pool.");
     }
@@ -63,7 +63,21 @@ public:
 
     const vk::CommandPool& getHandle() const noexcept { return *handle; }
 
+    /** Reset all command buffers allocated from the pool at once. The commands of all 
+        buffers must have completed. Without releaseResources, the pool keeps the 
+        memory for the next recording. */
+    void reset(bool releaseResources = false) const noexcept
+    {
+        jassert(handle);
+
+        const auto flags = releaseResources ? vk::CommandPoolResetFlags(vk::CommandPoolResetFlagBits::eReleaseResources) : vk::CommandPoolResetFlags();
+        const auto result = device.getHandle().resetCommandPool(getHandle(), flags);
+
+        PW_CHECK_VK_RESULT_SUCCESS(result, "Couldn't reset command pool.");
+    }
+
 private:
+    const VulkanDevice& device;
     vk::UniqueCommandPool handle;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VulkanCommandPool)
@@ -52,7 +52,7 @@ public:
         vk::Result result;
 
         jassert(instance.getHandle());
-        std::tie(result, handle) = instance.getHandle().createDebugUtilsMessengerEXTUnique(createInfo).asTuple();
+        std::tie(result, handle) = instance.getHandle().createDebugUtilsMessengerEXTUnique(createInfo, instance.getAllocationCallbacks()).asTuple();
 
         PW_CHECK_VK_RESULT_SUCCESS(result, "Couldn't create debug utils messenger");
     }
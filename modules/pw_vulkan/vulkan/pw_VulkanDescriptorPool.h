@@ -48,7 +48,7 @@ public:
         vk::Result result;
 
         jassert(device.getHandle());
-        std::tie(result, handle) = device.getHandle().createDescriptorPoolUnique(createInfo).asTuple();
+        std::tie(result, handle) = device.getHandle().createDescriptorPoolUnique(createInfo, device.getAllocationCallbacks()).asTuple();
 
         PW_CHECK_VK_RESULT_SUCCESS(result, "Couldn't create descriptor pool.");
     }
@@ -53,7 +53,7 @@ public:
         vk::Result result;
             
         jassert(device.getHandle());
-        std::tie(result, handle) = device.getHandle().createDescriptorSetLayoutUnique(createInfo).asTuple();
+        std::tie(result, handle) = device.getHandle().createDescriptorSetLayoutUnique(createInfo, device.getAllocationCallbacks()).asTuple();
 
         PW_CHECK_VK_RESULT_SUCCESS(result, "Couldn't create descriptor set layout.");
     }
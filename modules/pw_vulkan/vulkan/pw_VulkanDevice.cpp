@@ -39,7 +39,43 @@ juce::StringArray getRequiredExtensions() noexcept
     return extensions;
 }
 
-void getEnabledExtensions(const vk::PhysicalDevice& physicalDevice, const juce::StringArray& extensions, std::vector<const char*>& enabledExtensions)
+/** Extensions that are enabled if the driver supports them. */
+juce::StringArray getOptionalExtensions() noexcept
+{
+    static juce::StringArray extensions =
+    {
+        VK_KHR_GET_MEMORY_REQUIREMENTS_2_EXTENSION_NAME,
+        VK_KHR_DEDICATED_ALLOCATION_EXTENSION_NAME
+    };
+
+    return extensions;
+}
+
+/** Optional extensions that depend on VK_KHR_get_physical_device_properties2 in the instance. */
+juce::StringArray getOptionalProperties2Extensions() noexcept
+{
+    static juce::StringArray extensions =
+    {
+        VK_EXT_MEMORY_BUDGET_EXTENSION_NAME,
+        VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME
+    };
+
+    return extensions;
+}
+
+/** Optional extensions that depend on VK_KHR_external_memory_capabilities in the instance. */
+juce::StringArray getOptionalExternalMemoryExtensions() noexcept
+{
+    static juce::StringArray extensions =
+    {
+        VK_KHR_EXTERNAL_MEMORY_EXTENSION_NAME,
+        VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME
+    };
+
+    return extensions;
+}
+
+void getEnabledExtensions(const vk::PhysicalDevice& physicalDevice, const juce::StringArray& extensions, std::vector<const char*>& enabledExtensions, bool optional = false)
 {
     vk::Result result;
     std::vector<vk::ExtensionProperties> extensionProperties;
@@ -57,7 +93,7 @@ void getEnabledExtensions(const vk::PhysicalDevice& physicalDevice, const juce::
     }
 #endif
 
-    enabledExtensions.reserve(extensions.size());
+    enabledExtensions.reserve(enabledExtensions.size() + static_cast<size_t>(extensions.size()));
 
     for (const auto& extension : extensions)
     {
@@ -73,7 +109,7 @@ void getEnabledExtensions(const vk::PhysicalDevice& physicalDevice, const juce::
         if (available)
             enabledExtensions.push_back(extension.toUTF8());
         else
-            jassertfalse; // Requested device extension not available in driver.
+            jassert(optional); // Requested device extension not available in driver.
     }
 
 #if (PW_VULKAN_PRINT_DEVICE_EXTENSIONS_INFO == 1)
@@ -90,6 +126,16 @@ struct DeviceCreateInfo : public vk::DeviceCreateInfo
     DeviceCreateInfo(const VulkanPhysicalDevice& physicalDevice)
     {
         getEnabledExtensions(physicalDevice.getHandle(), getRequiredExtensions(), enabledExtensions);
+        getEnabledExtensions(physicalDevice.getHandle(), getOptionalExtensions(), enabledExtensions, true);
+
+        if (physicalDevice.getInstance().isExtensionEnabled(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME))
+            getEnabledExtensions(physicalDevice.getHandle(), getOptionalProperties2Extensions(), enabledExtensions, true);
+
+        if (physicalDevice.getInstance().isExtensionEnabled(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) 
+            && physicalDevice.getInstance().isExtensionEnabled(VK_KHR_EXTERNAL_MEMORY_CAPABILITIES_EXTENSION_NAME))
+            getEnabledExtensions(physicalDevice.getHandle(), getOptionalExternalMemoryExtensions(), enabledExtensions, true);
+
+        enableTimelineSemaphore(physicalDevice);
 
         for (const auto& queueFamily : physicalDevice.getQueueFamilies())
         {
@@ -106,12 +152,49 @@ struct DeviceCreateInfo : public vk::DeviceCreateInfo
         setPEnabledExtensionNames(enabledExtensions);
     }
 
+    /** The extension alone isn't enough, the feature has to be enabled as well. */
+    void enableTimelineSemaphore(const VulkanPhysicalDevice& physicalDevice)
+    {
+        const auto isTimelineExtension = [](const char* name) { return std::strcmp(name, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME) == 0; };
+
+        const auto extension = std::find_if(enabledExtensions.begin(), enabledExtensions.end(), isTimelineExtension);
+        if (extension == enabledExtensions.end())
+            return;
+
+        const auto features = physicalDevice.getHandle().getFeatures2KHR<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceTimelineSemaphoreFeatures>();
+
+        if (! features.get<vk::PhysicalDeviceTimelineSemaphoreFeatures>().timelineSemaphore)
+        {
+            enabledExtensions.erase(extension);
+            return;
+        }
+
+        timelineSemaphoreFeatures.setTimelineSemaphore(VK_TRUE);
+        setPNext(&timelineSemaphoreFeatures);
+    }
+
     float queuePriority = 1.0f;
     std::vector<vk::DeviceQueueCreateInfo> queueCreateInfos;
     
     std::vector<const char*> enabledExtensions;
+
+    vk::PhysicalDeviceTimelineSemaphoreFeatures timelineSemaphoreFeatures;
 };
 
+bool isTimelineSemaphoreFeatureEnabled(const vk::DeviceCreateInfo& createInfo) noexcept
+{
+    for (auto next = static_cast<const vk::BaseInStructure*>(createInfo.pNext); next != nullptr; next = next->pNext)
+    {
+        if (next->sType == vk::StructureType::ePhysicalDeviceTimelineSemaphoreFeatures)
+            return reinterpret_cast<const vk::PhysicalDeviceTimelineSemaphoreFeatures*>(next)->timelineSemaphore == VK_TRUE;
+
+        if (next->sType == vk::StructureType::ePhysicalDeviceVulkan12Features)
+            return reinterpret_cast<const vk::PhysicalDeviceVulkan12Features*>(next)->timelineSemaphore == VK_TRUE;
+    }
+
+    return false;
+}
+
 } // namespace VulkanDeviceHelpers
 
 //==============================================================================
@@ -121,7 +204,7 @@ VulkanDevice::VulkanDevice(const VulkanPhysicalDevice& physicalDevice_, const vk
     vk::Result result;
     
     jassert(physicalDevice.getHandle());
-    std::tie(result, handle) = physicalDevice.getHandle().createDeviceUnique(createInfo).asTuple();
+    std::tie(result, handle) = physicalDevice.getHandle().createDeviceUnique(createInfo, getAllocationCallbacks()).asTuple();
 
     PW_CHECK_VK_RESULT_SUCCESS(result, "Couldn't create device.");
 
@@ -129,6 +212,17 @@ VulkanDevice::VulkanDevice(const VulkanPhysicalDevice& physicalDevice_, const vk
     {
         PW_DBG_V("Created device.");
 
+        for (auto i = 0U; i < createInfo.enabledExtensionCount; ++i)
+            enabledExtensions.add(createInfo.ppEnabledExtensionNames[i]);
+
+        timelineSemaphoreEnabled = VulkanDeviceHelpers::isTimelineSemaphoreFeatureEnabled(createInfo);
+
+        if (supportsExternalHostMemory())
+        {
+            const auto properties = physicalDevice.getHandle().getProperties2KHR<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceExternalMemoryHostPropertiesEXT>();
+            minImportedHostPointerAlignment = properties.get<vk::PhysicalDeviceExternalMemoryHostPropertiesEXT>().minImportedHostPointerAlignment;
+        }
+
         // Find the first graphics queue family and set it as main
         for (const auto& queueFamily : physicalDevice.getQueueFamilies())
         {
@@ -136,15 +230,20 @@ VulkanDevice::VulkanDevice(const VulkanPhysicalDevice& physicalDevice_, const vk
             {
                 auto queue = std::make_unique<Queue>();
                 queue->handle = handle->getQueue(queueFamily.index, 0);
+                queue->familyIndex = queueFamily.index;
             
                 graphicsQueue = queues.add(queue.release());
                 graphicsCommandPool.reset(new VulkanCommandPool(*this, queueFamily.index));
+                commandRecycler.reset(new VulkanCommandRecycler(*this));
             
                 break;
             }
         }
 
         jassert(graphicsQueue != nullptr);
+
+        if (graphicsQueue != nullptr && supportsTimelineSemaphore())
+            timeline.reset(new VulkanTimeline(*this));
     }
 }
 
@@ -163,6 +262,100 @@ const VulkanCommandPool& VulkanDevice::getGraphicsCommandPool() const noexcept
     return *graphicsCommandPool;
 }
 
+VulkanCommandRecycler& VulkanDevice::getCommandRecycler() const noexcept
+{
+    jassert(commandRecycler != nullptr);
+    return *commandRecycler;
+}
+
+bool VulkanDevice::isExtensionEnabled(const char* extensionName) const noexcept
+{
+    return enabledExtensions.contains(extensionName);
+}
+
+bool VulkanDevice::supportsDedicatedAllocation() const noexcept
+{
+    return isExtensionEnabled(VK_KHR_GET_MEMORY_REQUIREMENTS_2_EXTENSION_NAME) 
+        && isExtensionEnabled(VK_KHR_DEDICATED_ALLOCATION_EXTENSION_NAME);
+}
+
+bool VulkanDevice::supportsMemoryBudget() const noexcept
+{
+    return isExtensionEnabled(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+}
+
+bool VulkanDevice::supportsExternalHostMemory() const noexcept
+{
+    return isExtensionEnabled(VK_KHR_EXTERNAL_MEMORY_EXTENSION_NAME) 
+        && isExtensionEnabled(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
+}
+
+bool VulkanDevice::supportsTimelineSemaphore() const noexcept
+{
+    return timelineSemaphoreEnabled && isExtensionEnabled(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+}
+
+juce::Array<VulkanDevice::MemoryBudget> VulkanDevice::getMemoryBudgets() const
+{
+    const auto& memoryProperties = physicalDevice.getMemoryProperties();
+    const auto heapCount = memoryProperties.memoryHeapCount;
+
+    juce::Array<MemoryBudget> budgets;
+    budgets.resize(static_cast<int>(heapCount));
+
+    if (supportsMemoryBudget())
+    {
+        const auto properties = physicalDevice.getHandle().getMemoryProperties2KHR<vk::PhysicalDeviceMemoryProperties2, vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+        const auto& budgetProperties = properties.get<vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+
+        for (auto i = 0U; i < heapCount; ++i)
+        {
+            auto& budget = budgets.getReference(static_cast<int>(i));
+
+            budget.budget = budgetProperties.heapBudget[i];
+            budget.usage = budgetProperties.heapUsage[i];
+        }
+    }
+    else
+    {
+        // Without the extension only the heap size and our own allocations are known
+        for (auto i = 0U; i < heapCount; ++i)
+        {
+            auto& budget = budgets.getReference(static_cast<int>(i));
+
+            budget.budget = memoryProperties.memoryHeaps[i].size;
+            budget.usage = getAllocatedSize(i);
+        }
+    }
+
+    return budgets;
+}
+
+const vk::AllocationCallbacks* VulkanDevice::getAllocationCallbacks() const noexcept
+{
+    return physicalDevice.getInstance().getAllocationCallbacks();
+}
+
+vk::DeviceSize VulkanDevice::getAllocatedSize(uint32_t heapIndex) const noexcept
+{
+    jassert(heapIndex < VK_MAX_MEMORY_HEAPS);
+    return allocatedSizes[heapIndex].load();
+}
+
+void VulkanDevice::addAllocatedSize(uint32_t memoryTypeIndex, vk::DeviceSize size) const noexcept
+{
+    const auto heapIndex = physicalDevice.getMemoryProperties().memoryTypes[memoryTypeIndex].heapIndex;
+    allocatedSizes[heapIndex] += size;
+}
+
+void VulkanDevice::removeAllocatedSize(uint32_t memoryTypeIndex, vk::DeviceSize size) const noexcept
+{
+    const auto heapIndex = physicalDevice.getMemoryProperties().memoryTypes[memoryTypeIndex].heapIndex;
+    
+    jassert(allocatedSizes[heapIndex].load() >= size);
+    allocatedSizes[heapIndex] -= size;
+}
+
 const VulkanDevice::Queue& VulkanDevice::getGraphicsQueue() const noexcept
 {
     jassert(graphicsQueue != nullptr);
@@ -237,6 +430,32 @@ vk::Result VulkanDevice::Queue::submit(const vk::SubmitInfo& submitInfo, vk::Fen
     return result;
 }
 
+vk::Result VulkanDevice::Queue::submit(uint32_t submitCount, const vk::SubmitInfo* submitInfos, vk::Fence fence) const noexcept
+{
+    jassert(handle);
+    const auto result = handle.submit(submitCount, submitInfos, fence);
+
+    PW_CHECK_VK_RESULT_SUCCESS(result, "Failed to submit to queue.");
+
+    return result;
+}
+
+vk::Result VulkanDevice::Queue::signal(const VulkanSemaphore& timelineSemaphore, uint64_t value, vk::Fence fence) const noexcept
+{
+    jassert(timelineSemaphore.isTimeline());
+
+    const auto timelineInfo = vk::TimelineSemaphoreSubmitInfo()
+        .setSignalSemaphoreValueCount(1)
+        .setPSignalSemaphoreValues(&value);
+
+    const auto submitInfo = vk::SubmitInfo()
+        .setPNext(&timelineInfo)
+        .setSignalSemaphoreCount(1)
+        .setPSignalSemaphores(&timelineSemaphore.getHandle());
+
+    return submit(submitInfo, fence);
+}
+
 vk::Result VulkanDevice::Queue::waitIdle() const noexcept
 {
     jassert(handle);
@@ -50,9 +50,26 @@ public:
 
         vk::Result submit(const vk::SubmitInfo& submitInfo, vk::Fence fence = nullptr) const noexcept;
 
+        vk::Result submit(uint32_t submitCount, const vk::SubmitInfo* submitInfos, vk::Fence fence = nullptr) const noexcept;
+
+        /** Signal the value of a timeline semaphore, once all previously submitted commands have completed. */
+        vk::Result signal(const VulkanSemaphore& timelineSemaphore, uint64_t value, vk::Fence fence = nullptr) const noexcept;
+
         vk::Result waitIdle() const noexcept;
 
         vk::Queue handle;
+        uint32_t familyIndex = 0;
+    };
+
+    /** Budget and current usage of a memory heap in bytes. */
+    struct MemoryBudget final
+    {
+        vk::DeviceSize getAvailable() const noexcept { return budget > usage ? budget - usage : 0; }
+
+        float getUsageRatio() const noexcept { return budget > 0 ? static_cast<float>(usage) / static_cast<float>(budget) : 0.0f; }
+
+        vk::DeviceSize budget = 0;
+        vk::DeviceSize usage = 0;
     };
 
 private:
@@ -69,10 +86,46 @@ public:
 
     const VulkanPhysicalDevice& getPhysicalDevice() const noexcept { return physicalDevice; }
 
+    /** The allocation callbacks of the instance, nullptr if the driver uses its own allocator. */
+    const vk::AllocationCallbacks* getAllocationCallbacks() const noexcept;
+
+    bool isExtensionEnabled(const char* extensionName) const noexcept;
+
+    /** True if VK_KHR_dedicated_allocation and VK_KHR_get_memory_requirements2 are enabled. */
+    bool supportsDedicatedAllocation() const noexcept;
+
+    /** True if VK_EXT_memory_budget is enabled. */
+    bool supportsMemoryBudget() const noexcept;
+
+    /** True if VK_EXT_external_memory_host and VK_KHR_external_memory are enabled. */
+    bool supportsExternalHostMemory() const noexcept;
+
+    /** The alignment of host pointers and sizes that are imported as device memory, 
+        0 if external host memory isn't supported. */
+    vk::DeviceSize getMinImportedHostPointerAlignment() const noexcept { return minImportedHostPointerAlignment; }
+
+    /** True if VK_KHR_timeline_semaphore and the timelineSemaphore feature are enabled. */
+    bool supportsTimelineSemaphore() const noexcept;
+
+    /** The timeline of the graphics queue, nullptr if timeline semaphores aren't supported. */
+    VulkanTimeline* getTimeline() const noexcept { return timeline.get(); }
+
+    /** Get the budget of every memory heap. With VK_EXT_memory_budget these are the values 
+        reported by the driver, which include the allocations of other devices and processes. 
+        Otherwise the budget is the heap size and the usage covers only the memory allocated 
+        through this device. */
+    juce::Array<MemoryBudget> getMemoryBudgets() const;
+
+    /** The size of all VulkanDeviceMemory currently allocated on the heap. */
+    vk::DeviceSize getAllocatedSize(uint32_t heapIndex) const noexcept;
+
     const Queue& getGraphicsQueue() const noexcept;
 
     const VulkanCommandPool& getGraphicsCommandPool() const noexcept;
 
+    /** Recycles the command buffers of the graphics command pool and binary semaphores. */
+    VulkanCommandRecycler& getCommandRecycler() const noexcept;
+
     bool hasAssociatedObject() const noexcept;
 
     juce::ReferenceCountedObject* getAssociatedObject(const char* name) const;
@@ -88,15 +141,33 @@ public:
         juce::ignoreUnused(result);
     }
 
+private:
+    friend class VulkanDeviceMemory;
+
+    void addAllocatedSize(uint32_t memoryTypeIndex, vk::DeviceSize size) const noexcept;
+
+    void removeAllocatedSize(uint32_t memoryTypeIndex, vk::DeviceSize size) const noexcept;
+
 private:
     const VulkanPhysicalDevice& physicalDevice;
     
     vk::UniqueDevice handle;
 
+    juce::StringArray enabledExtensions;
+
+    vk::DeviceSize minImportedHostPointerAlignment = 0;
+
+    bool timelineSemaphoreEnabled = false;
+
+    mutable std::array<std::atomic<vk::DeviceSize>, VK_MAX_MEMORY_HEAPS> allocatedSizes {};
+
     juce::OwnedArray<const Queue> queues;
 
     const Queue* graphicsQueue = nullptr;
     std::unique_ptr<VulkanCommandPool> graphicsCommandPool;
+    std::unique_ptr<VulkanCommandRecycler> commandRecycler;
+
+    std::unique_ptr<VulkanTimeline> timeline;
     
     juce::StringArray associatedObjectNames;
     juce::ReferenceCountedArray<juce::ReferenceCountedObject> associatedObjects;
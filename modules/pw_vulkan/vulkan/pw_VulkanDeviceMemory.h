@@ -45,21 +45,34 @@ private:
     VulkanDeviceMemory() = delete;
 
 public:
-    VulkanDeviceMemory(const VulkanDevice& device, const vk::MemoryAllocateInfo& allocateInfo)
+    VulkanDeviceMemory(const VulkanDevice& device_, const vk::MemoryAllocateInfo& allocateInfo) :
+        device(device_), memoryTypeIndex(allocateInfo.memoryTypeIndex), size(allocateInfo.allocationSize)
     {
         vk::Result result;
 
         jassert(device.getHandle());
-        std::tie(result, handle) = device.getHandle().allocateMemoryUnique(allocateInfo).asTuple();
+        std::tie(result, handle) = device.getHandle().allocateMemoryUnique(allocateInfo, device.getAllocationCallbacks()).asTuple();
 
         PW_CHECK_VK_RESULT_SUCCESS(result, "Failed to allocate device memory.");
+
+        if (handle)
+            device.addAllocatedSize(memoryTypeIndex, size);
     }
     
-    ~VulkanDeviceMemory() = default;
+    ~VulkanDeviceMemory()
+    {
+        if (handle)
+            device.removeAllocatedSize(memoryTypeIndex, size);
+    }
 
     const vk::DeviceMemory& getHandle() const noexcept { return *handle; }
 
 private:
+    const VulkanDevice& device;
+    
+    const uint32_t memoryTypeIndex;
+    const vk::DeviceSize size;
+
     vk::UniqueDeviceMemory handle;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VulkanDeviceMemory)
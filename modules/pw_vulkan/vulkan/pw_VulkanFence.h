@@ -53,7 +53,7 @@ public:
         vk::Result result;
 
         jassert(device.getHandle());
-        std::tie(result, handle) = device.getHandle().createFenceUnique(createInfo).asTuple();
+        std::tie(result, handle) = device.getHandle().createFenceUnique(createInfo, device.getAllocationCallbacks()).asTuple();
 
         PW_CHECK_VK_RESULT_SUCCESS(result, "Couldn't create fence.");
     }
@@ -76,6 +76,12 @@ public:
     }
 
     bool wait(juce::RelativeTime duration = juce::RelativeTime::seconds(1.0)) const noexcept
+    {
+        return waitForResult(duration) == vk::Result::eSuccess;
+    }
+
+    /** Returns eSuccess, eTimeout or the error of the wait, e.g. eErrorDeviceLost. */
+    vk::Result waitForResult(juce::RelativeTime duration = juce::RelativeTime::seconds(1.0)) const noexcept
     {
         const auto timeout = static_cast<uint64_t>(std::max<int64_t>(0, duration.inMilliseconds())) * 1000; // Nano Seconds
 
@@ -84,16 +90,24 @@ public:
 
         PW_CHECK_VK_RESULT(result == vk::Result::eSuccess || result == vk::Result::eTimeout, result, "Couldn't wait for fence.");
 
-        return result == vk::Result::eSuccess;
+        return result;
     }
 
-    /** Idles in a sleep loop with the specified duration until the fence wait completes. */
-    void waitIdle(juce::RelativeTime duration = juce::RelativeTime::milliseconds(10)) const noexcept
+    /** Idles in a sleep loop with the specified duration until the fence wait completes. 
+        Returns false if the wait failed with an error, e.g. because the device was lost. */
+    bool waitIdle(juce::RelativeTime duration = juce::RelativeTime::milliseconds(10)) const noexcept
     {
         const auto halfDuration = static_cast<int>(duration.seconds(duration.inSeconds() / 2.0).inMilliseconds());
 
-        while (! wait(duration))
+        for (;;)
+        {
+            const auto result = waitForResult(duration);
+
+            if (result != vk::Result::eTimeout)
+                return result == vk::Result::eSuccess;
+
             juce::Thread::sleep(halfDuration);
+        }
     }
 
     bool reset() const noexcept
@@ -64,7 +64,7 @@ public:
         vk::Result result;
 
         jassert(device.getHandle());
-        std::tie(result, handle) = device.getHandle().createFramebufferUnique(createInfo).asTuple();
+        std::tie(result, handle) = device.getHandle().createFramebufferUnique(createInfo, device.getAllocationCallbacks()).asTuple();
 
         PW_CHECK_VK_RESULT_SUCCESS(result, "Couldn't create framebuffer");
     }
@@ -0,0 +1,369 @@
+/*
+  ==============================================================================
+
+   This file is part of the Parawave Vulkan C++ library.
+
+   The code included in this file is provided under the terms of the ISC license
+   https://opensource.org/licenses/ISC.
+
+   Copyright (c) 2021 - Parawave Audio (https://parawave-audio.com/vulkan-cpp-library)
+
+   Permission to use, copy, modify, and/or distribute this software for any 
+   purpose with or without fee is hereby granted, provided that the above 
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES 
+   WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF 
+   MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+   SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES 
+   WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+   OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN 
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace parawave
+{
+    
+//==============================================================================
+/** 
+    VulkanHostAllocator
+
+    Backs the host memory allocations of the driver (VkAllocationCallbacks). 
+    Pass it to the VulkanInstance, all objects of the instance and its devices 
+    are then created with these callbacks.
+
+    Small allocations are served from free lists of power of two size classes, 
+    carved out of larger chunks that are kept until the allocator is destroyed. 
+    Bigger allocations go directly to the system allocator.
+
+    The statistics count the live allocations and bytes per allocation scope, 
+    and the total number of allocations and frees. The difference of the totals 
+    between two frames is the driver side churn of that frame.
+
+    The allocator must outlive the instance and all of its objects.
+*/
+class VulkanHostAllocator final
+{
+private:
+    enum
+    {
+        numScopes = 5,
+
+        minSizeClassLog2 = 5,
+        maxSizeClassLog2 = 12,
+        numSizeClasses = maxSizeClassLog2 - minSizeClassLog2 + 1,
+
+        chunkSize = 64 * 1024
+    };
+
+public:
+    struct Statistics final
+    {
+        struct Scope
+        {
+            juce::var toVar() const
+            {
+                auto object = new juce::DynamicObject();
+
+                object->setProperty("numAllocations", static_cast<juce::int64>(numAllocations));
+                object->setProperty("bytes", static_cast<juce::int64>(bytes));
+                object->setProperty("totalAllocations", static_cast<juce::int64>(totalAllocations));
+                object->setProperty("totalFrees", static_cast<juce::int64>(totalFrees));
+
+                return juce::var(object);
+            }
+
+            juce::uint64 numAllocations = 0;
+            juce::uint64 bytes = 0;
+
+            juce::uint64 totalAllocations = 0;
+            juce::uint64 totalFrees = 0;
+        };
+
+        juce::var toVar() const
+        {
+            auto object = new juce::DynamicObject();
+
+            for (size_t i = 0; i < scopes.size(); ++i)
+                object->setProperty(juce::Identifier(juce::String(vk::to_string(static_cast<vk::SystemAllocationScope>(i)))), scopes[i].toVar());
+
+            object->setProperty("internal", internal.toVar());
+            object->setProperty("chunkBytes", static_cast<juce::int64>(chunkBytes));
+
+            return juce::var(object);
+        }
+
+        /** Indexed by vk::SystemAllocationScope. */
+        std::array<Scope, numScopes> scopes;
+
+        /** Allocations the driver made by itself and only reported. */
+        Scope internal;
+
+        /** Memory held by the size classes, used or not. */
+        juce::uint64 chunkBytes = 0;
+    };
+
+public:
+    VulkanHostAllocator() noexcept
+    {
+        callbacks
+            .setPUserData(this)
+            .setPfnAllocation(&allocationFunction)
+            .setPfnReallocation(&reallocationFunction)
+            .setPfnFree(&freeFunction)
+            .setPfnInternalAllocation(&internalAllocationNotification)
+            .setPfnInternalFree(&internalFreeNotification);
+    }
+
+    ~VulkanHostAllocator()
+    {
+        // The instance or one of its objects is still alive!
+        jassert(getNumAllocations() == 0);
+
+        for (auto chunk : chunks)
+            std::free(chunk);
+    }
+
+    const vk::AllocationCallbacks* getCallbacks() const noexcept { return &callbacks; }
+
+    Statistics getStatistics() const noexcept
+    {
+        const juce::SpinLock::ScopedLockType sl(lock);
+        return statistics;
+    }
+
+    juce::uint64 getNumAllocations() const noexcept
+    {
+        const juce::SpinLock::ScopedLockType sl(lock);
+
+        juce::uint64 numAllocations = 0;
+
+        for (const auto& scope : statistics.scopes)
+            numAllocations += scope.numAllocations;
+
+        return numAllocations;
+    }
+
+private:
+    /** Stored in front of every allocation. */
+    struct Header
+    {
+        void* base;
+        size_t size;
+        int sizeClass;
+        int scope;
+    };
+
+    struct FreeSlot
+    {
+        FreeSlot* next;
+    };
+
+    static int getSizeClass(size_t size) noexcept
+    {
+        for (int i = 0; i < numSizeClasses; ++i)
+            if (size <= (size_t(1) << (minSizeClassLog2 + i)))
+                return i;
+
+        return -1;
+    }
+
+    void* allocate(size_t size, size_t alignment, vk::SystemAllocationScope scope)
+    {
+        alignment = std::max(alignment, alignof(Header));
+        jassert(juce::isPowerOfTwo(alignment));
+
+        const auto requiredSize = sizeof(Header) + alignment - 1 + size;
+        auto sizeClass = getSizeClass(requiredSize);
+
+        void* base = nullptr;
+
+        if (sizeClass >= 0)
+        {
+            const juce::SpinLock::ScopedLockType sl(lock);
+            base = acquireSlot(sizeClass);
+        }
+
+        if (base == nullptr)
+        {
+            sizeClass = -1;
+            base = std::malloc(requiredSize);
+
+            if (base == nullptr)
+                return nullptr;
+        }
+
+        {
+            const juce::SpinLock::ScopedLockType sl(lock);
+
+            auto& scopeStatistics = statistics.scopes[static_cast<size_t>(scope)];
+
+            ++scopeStatistics.numAllocations;
+            ++scopeStatistics.totalAllocations;
+            scopeStatistics.bytes += size;
+        }
+
+        const auto address = (reinterpret_cast<uintptr_t>(base) + sizeof(Header) + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+        auto header = reinterpret_cast<Header*>(address) - 1;
+
+        header->base = base;
+        header->size = size;
+        header->sizeClass = sizeClass;
+        header->scope = static_cast<int>(scope);
+
+        return reinterpret_cast<void*>(address);
+    }
+
+    void* reallocate(void* original, size_t size, size_t alignment, vk::SystemAllocationScope scope)
+    {
+        if (original == nullptr)
+            return allocate(size, alignment, scope);
+
+        if (size == 0)
+        {
+            free(original);
+            return nullptr;
+        }
+
+        const auto originalSize = (static_cast<Header*>(original) - 1)->size;
+
+        auto memory = allocate(size, alignment, scope);
+
+        if (memory != nullptr)
+        {
+            std::memcpy(memory, original, std::min(size, originalSize));
+            free(original);
+        }
+
+        return memory;
+    }
+
+    void free(void* memory)
+    {
+        if (memory == nullptr)
+            return;
+
+        const auto header = *(static_cast<Header*>(memory) - 1);
+
+        {
+            const juce::SpinLock::ScopedLockType sl(lock);
+
+            auto& scopeStatistics = statistics.scopes[static_cast<size_t>(header.scope)];
+
+            --scopeStatistics.numAllocations;
+            ++scopeStatistics.totalFrees;
+            scopeStatistics.bytes -= header.size;
+
+            if (header.sizeClass >= 0)
+            {
+                auto slot = static_cast<FreeSlot*>(header.base);
+
+                slot->next = freeSlots[static_cast<size_t>(header.sizeClass)];
+                freeSlots[static_cast<size_t>(header.sizeClass)] = slot;
+
+                return;
+            }
+        }
+
+        std::free(header.base);
+    }
+
+    /** Called with the lock held. Returns nullptr if no chunk could be allocated. */
+    void* acquireSlot(int sizeClass)
+    {
+        auto& freeList = freeSlots[static_cast<size_t>(sizeClass)];
+
+        if (freeList == nullptr)
+        {
+            auto chunk = static_cast<uint8_t*>(std::malloc(chunkSize));
+
+            if (chunk == nullptr)
+                return nullptr;
+
+            chunks.push_back(chunk);
+            statistics.chunkBytes += chunkSize;
+
+            const auto slotSize = size_t(1) << (minSizeClassLog2 + sizeClass);
+
+            // Link the slots in address order
+            for (auto i = static_cast<size_t>(chunkSize) / slotSize; i-- > 0;)
+            {
+                auto slot = reinterpret_cast<FreeSlot*>(chunk + i * slotSize);
+
+                slot->next = freeList;
+                freeList = slot;
+            }
+        }
+
+        auto slot = freeList;
+        freeList = slot->next;
+
+        return slot;
+    }
+
+    void notifyInternal(size_t size, bool allocated) noexcept
+    {
+        const juce::SpinLock::ScopedLockType sl(lock);
+
+        auto& internal = statistics.internal;
+
+        if (allocated)
+        {
+            ++internal.numAllocations;
+            ++internal.totalAllocations;
+            internal.bytes += size;
+        }
+        else
+        {
+            --internal.numAllocations;
+            ++internal.totalFrees;
+            internal.bytes -= size;
+        }
+    }
+
+    //==============================================================================
+    static VulkanHostAllocator& getAllocator(void* userData) noexcept { return *static_cast<VulkanHostAllocator*>(userData); }
+
+    static VKAPI_ATTR void* VKAPI_CALL allocationFunction(void* userData, size_t size, size_t alignment, VkSystemAllocationScope scope)
+    {
+        return getAllocator(userData).allocate(size, alignment, static_cast<vk::SystemAllocationScope>(scope));
+    }
+
+    static VKAPI_ATTR void* VKAPI_CALL reallocationFunction(void* userData, void* original, size_t size, size_t alignment, VkSystemAllocationScope scope)
+    {
+        return getAllocator(userData).reallocate(original, size, alignment, static_cast<vk::SystemAllocationScope>(scope));
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL freeFunction(void* userData, void* memory)
+    {
+        getAllocator(userData).free(memory);
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL internalAllocationNotification(void* userData, size_t size, VkInternalAllocationType, VkSystemAllocationScope)
+    {
+        getAllocator(userData).notifyInternal(size, true);
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL internalFreeNotification(void* userData, size_t size, VkInternalAllocationType, VkSystemAllocationScope)
+    {
+        getAllocator(userData).notifyInternal(size, false);
+    }
+
+private:
+    vk::AllocationCallbacks callbacks;
+
+    mutable juce::SpinLock lock;
+
+    std::array<FreeSlot*, numSizeClasses> freeSlots {};
+    std::vector<void*> chunks;
+
+    Statistics statistics;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VulkanHostAllocator)
+};
+
+} // namespace parawave
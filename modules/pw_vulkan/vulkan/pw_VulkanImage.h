@@ -67,7 +67,7 @@ public:
         vk::Result result;
 
         jassert(device.getHandle());
-        std::tie(result, handle) = device.getHandle().createImageUnique(createInfo).asTuple();
+        std::tie(result, handle) = device.getHandle().createImageUnique(createInfo, device.getAllocationCallbacks()).asTuple();
 
         PW_CHECK_VK_RESULT_SUCCESS(result, "Couldn't create image.");
     }
@@ -100,6 +100,18 @@ public:
         return device.getHandle().getImageMemoryRequirements(getHandle());
     }
 
+    /** The offset and row pitch of the first color layer. Only valid for images with linear tiling. */
+    vk::SubresourceLayout getSubresourceLayout() const noexcept
+    {
+        const auto subresource = vk::ImageSubresource()
+            .setAspectMask(vk::ImageAspectFlagBits::eColor)
+            .setMipLevel(0)
+            .setArrayLayer(0);
+
+        jassert(getHandle() && device.getHandle());
+        return device.getHandle().getImageSubresourceLayout(getHandle(), subresource);
+    }
+
 private:
     const VulkanDevice& device;
 
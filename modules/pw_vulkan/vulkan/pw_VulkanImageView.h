@@ -62,7 +62,7 @@ public:
         vk::Result result;
     
         jassert(device.getHandle());
-        std::tie(result, handle) = device.getHandle().createImageViewUnique(createInfo).asTuple();
+        std::tie(result, handle) = device.getHandle().createImageViewUnique(createInfo, device.getAllocationCallbacks()).asTuple();
 
         PW_CHECK_VK_RESULT_SUCCESS(result, "Couldn't create image view.");
     }
@@ -72,6 +72,18 @@ juce::StringArray getExtensions() noexcept
     return extensions;
 }
 
+/** Extensions that are enabled if the driver supports them. */
+juce::StringArray getOptionalExtensions() noexcept
+{
+    static juce::StringArray extensions =
+    {
+        VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME,
+        VK_KHR_EXTERNAL_MEMORY_CAPABILITIES_EXTENSION_NAME
+    };
+
+    return extensions;
+}
+
 void initialiseDynamicLoader()
 {
 #if (VULKAN_HPP_DISPATCH_LOADER_DYNAMIC == 1)
@@ -144,7 +156,7 @@ void getEnabledLayers(const juce::StringArray& layers, std::vector<const char*>&
 #endif
 }
 
-void getEnabledExtensions(const juce::StringArray& extensions, std::vector<const char*>& enabledExtensions)
+void getEnabledExtensions(const juce::StringArray& extensions, std::vector<const char*>& enabledExtensions, bool optional = false)
 {
     vk::Result result;
     std::vector<vk::ExtensionProperties> extensionProperties;
@@ -164,7 +176,7 @@ void getEnabledExtensions(const juce::StringArray& extensions, std::vector<const
     }
 #endif
 
-    enabledExtensions.reserve(extensions.size());
+    enabledExtensions.reserve(enabledExtensions.size() + static_cast<size_t>(extensions.size()));
     
     for (const auto& extension : extensions)
     {
@@ -178,7 +190,7 @@ void getEnabledExtensions(const juce::StringArray& extensions, std::vector<const
         if (available)
             enabledExtensions.push_back(extension.toUTF8());
         else
-            jassertfalse; // Requested extension not available in driver.
+            jassert(optional); // Requested extension not available in driver.
     }
 
 #if (PW_VULKAN_PRINT_INSTANCE_EXTENSIONS_INFO == 1)
@@ -202,6 +214,7 @@ VulkanInstance::CreateInfo::CreateInfo(uint32_t apiVersion)
     
     getEnabledLayers(getLayers(), enabledLayers);
     getEnabledExtensions(getExtensions(), enabledExtensions);
+    getEnabledExtensions(getOptionalExtensions(), enabledExtensions, true);
 
     applicationInfo
         .setPApplicationName(nullptr)
@@ -223,11 +236,12 @@ VulkanInstance::CreateInfo::CreateInfo(uint32_t apiVersion)
 
 //==============================================================================
 
-VulkanInstance::VulkanInstance(const vk::InstanceCreateInfo& createInfo)
+VulkanInstance::VulkanInstance(const vk::InstanceCreateInfo& createInfo, VulkanHostAllocator* hostAllocator_)
+    : hostAllocator(hostAllocator_)
 {
     vk::Result result;
 
-    std::tie(result, handle) = vk::createInstanceUnique(createInfo).asTuple();
+    std::tie(result, handle) = vk::createInstanceUnique(createInfo, getAllocationCallbacks()).asTuple();
 
     PW_CHECK_VK_RESULT_SUCCESS(result, "Couldn't create instance.");
 
@@ -235,6 +249,9 @@ VulkanInstance::VulkanInstance(const vk::InstanceCreateInfo& createInfo)
     {
         version = createInfo.pApplicationInfo->apiVersion;
 
+        for (auto i = 0U; i < createInfo.enabledExtensionCount; ++i)
+            enabledExtensions.add(createInfo.ppEnabledExtensionNames[i]);
+
         DBG(getVersionString());
         PW_DBG_V("Created instance.");
 
@@ -266,6 +283,11 @@ juce::String VulkanInstance::getVersionString() const noexcept
     return versionString;
 }
 
+bool VulkanInstance::isExtensionEnabled(const char* extensionName) const noexcept
+{
+    return enabledExtensions.contains(extensionName);
+}
+
 void VulkanInstance::enumeratePhysicalDevices()
 {
     vk::Result result;
@@ -36,6 +36,10 @@ namespace parawave
     in an instance object. Creating an instance object initializes the Vulkan 
     library and allows the application to pass information about itself to the 
     implementation.
+
+    Optionally the host allocations of the driver are made through a 
+    VulkanHostAllocator. All objects of the instance and its devices are then 
+    created and destroyed with its allocation callbacks.
 */
 class VulkanInstance final
 {
@@ -58,10 +62,10 @@ public:
     };
 
 public:
-    VulkanInstance(const vk::InstanceCreateInfo& createInfo);
+    VulkanInstance(const vk::InstanceCreateInfo& createInfo, VulkanHostAllocator* hostAllocator = nullptr);
 
-    explicit VulkanInstance(uint32_t apiVersion)
-        : VulkanInstance(CreateInfo(apiVersion)) {}
+    explicit VulkanInstance(uint32_t apiVersion, VulkanHostAllocator* hostAllocator = nullptr)
+        : VulkanInstance(CreateInfo(apiVersion), hostAllocator) {}
 
     VulkanInstance() : VulkanInstance(apiVersion1_0) {}
 
@@ -69,18 +73,30 @@ public:
 
     const vk::Instance& getHandle() const noexcept { return *handle; }
 
+    /** The host allocator of the instance or nullptr, if the driver uses its own allocator. */
+    VulkanHostAllocator* getHostAllocator() const noexcept { return hostAllocator; }
+
+    /** Pass them to every object created with the instance or one of its devices. */
+    const vk::AllocationCallbacks* getAllocationCallbacks() const noexcept { return hostAllocator != nullptr ? hostAllocator->getCallbacks() : nullptr; }
+
     uint32_t getVersion() const noexcept { return version; }
 
     juce::String getVersionString() const noexcept;
 
+    bool isExtensionEnabled(const char* extensionName) const noexcept;
+
     const juce::OwnedArray<const VulkanPhysicalDevice>& getPhysicalDevices() const noexcept { return physicalDevices; }
 
 private:
     void enumeratePhysicalDevices();
 
 private:
+    VulkanHostAllocator* const hostAllocator;
+
     vk::UniqueInstance handle;
 
+    juce::StringArray enabledExtensions;
+
     juce::OwnedArray<const VulkanPhysicalDevice> physicalDevices;
 
     std::unique_ptr<VulkanDebugUtilsMessenger> debugUtilsMessenger;
@@ -75,6 +75,37 @@ VulkanPhysicalDevice::VulkanPhysicalDevice(const VulkanInstance& instance_, cons
     }
 }
 
+bool VulkanPhysicalDevice::hasUnifiedMemory() const noexcept
+{
+    if (isDiscreteGpu())
+        return false;
+
+    auto hasDeviceLocalHeap = false;
+
+    for (auto heapIndex = 0U; heapIndex < memoryProperties.memoryHeapCount; ++heapIndex)
+    {
+        if (! (memoryProperties.memoryHeaps[heapIndex].flags & vk::MemoryHeapFlagBits::eDeviceLocal))
+            continue;
+
+        hasDeviceLocalHeap = true;
+
+        auto isHostVisible = false;
+
+        for (auto i = 0U; i < memoryProperties.memoryTypeCount; ++i)
+        {
+            const auto& memoryType = memoryProperties.memoryTypes[i];
+
+            if (memoryType.heapIndex == heapIndex && (memoryType.propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible))
+                isHostVisible = true;
+        }
+
+        if (! isHostVisible)
+            return false;
+    }
+
+    return hasDeviceLocalHeap;
+}
+
 bool VulkanPhysicalDevice::isSurfaceSupported(const vk::SurfaceKHR& surface) const noexcept
 {
     for (const auto& queueFamily : queueFamilies)
@@ -71,6 +71,11 @@ public:
 
     bool isDiscreteGpu() const noexcept { return type == vk::PhysicalDeviceType::eDiscreteGpu; }
 
+    /** True if the device isn't a discrete GPU and all of its device local memory is also host 
+        visible, e.g. integrated GPUs and CPU implementations. Resources can be written directly 
+        by the host, without a copy from a staging buffer. */
+    bool hasUnifiedMemory() const noexcept;
+
     bool isSurfaceSupported(const vk::SurfaceKHR& surface) const noexcept;
 
     const juce::Array<QueueFamily>& getQueueFamilies() const noexcept { return queueFamilies; }
@@ -43,7 +43,7 @@ public:
         vk::Result result;
 
         jassert(device.getHandle());
-        std::tie(result, handle) = device.getHandle().createGraphicsPipelineUnique(nullptr, createInfo).asTuple();
+        std::tie(result, handle) = device.getHandle().createGraphicsPipelineUnique(nullptr, createInfo, device.getAllocationCallbacks()).asTuple();
         
         PW_CHECK_VK_RESULT(result == vk::Result::eSuccess || result == vk::Result::ePipelineCompileRequiredEXT, result, "Couldn't create graphics pipeline.");
 
@@ -61,7 +61,7 @@ public:
         vk::Result result;
 
         jassert(device.getHandle());
-        std::tie(result, handle) = device.getHandle().createComputePipelineUnique(nullptr, createInfo).asTuple();
+        std::tie(result, handle) = device.getHandle().createComputePipelineUnique(nullptr, createInfo, device.getAllocationCallbacks()).asTuple();
 
         PW_CHECK_VK_RESULT(result == vk::Result::eSuccess || result == vk::Result::ePipelineCompileRequiredEXT, result, "Couldn't create compute pipeline.");
 
@@ -82,7 +82,7 @@ public:
         vk::Result result;
     
         jassert(device.getHandle());
-        std::tie(result, handle) = device.getHandle().createSamplerUnique(createInfo).asTuple();
+        std::tie(result, handle) = device.getHandle().createSamplerUnique(createInfo, device.getAllocationCallbacks()).asTuple();
 
         PW_CHECK_VK_RESULT_SUCCESS(result, "Couldn't create sampler.");
     }
@@ -35,6 +35,12 @@ namespace parawave
     Semaphores are a synchronization primitive that can be used to insert a 
     dependency between queue operations or between a queue operation and the 
     host. 
+
+    A binary semaphore is either signaled or unsignaled. A timeline semaphore 
+    (VK_KHR_timeline_semaphore, core in Vulkan 1.2) has a 64-bit counter, which 
+    increases with every signal operation. Queue operations and the host can wait 
+    for the counter to reach a value, so one semaphore can track any number of 
+    submissions.
 */
 class VulkanSemaphore final
 {
@@ -42,26 +48,114 @@ private:
     VulkanSemaphore() = delete;
 
 public:
-    VulkanSemaphore(const VulkanDevice& device, const vk::SemaphoreCreateInfo& createInfo)
+    VulkanSemaphore(const VulkanDevice& device_, const vk::SemaphoreCreateInfo& createInfo) : device(device_)
     {
         vk::Result result;
 
         jassert(device.getHandle());
-        std::tie(result, handle) = device.getHandle().createSemaphoreUnique(createInfo).asTuple();
+        std::tie(result, handle) = device.getHandle().createSemaphoreUnique(createInfo, device.getAllocationCallbacks()).asTuple();
         
         PW_CHECK_VK_RESULT_SUCCESS(result, "Couldn't create semaphore.");
+
+        for (auto next = static_cast<const vk::BaseInStructure*>(createInfo.pNext); next != nullptr; next = next->pNext)
+            if (next->sType == vk::StructureType::eSemaphoreTypeCreateInfo)
+                timeline = reinterpret_cast<const vk::SemaphoreTypeCreateInfo*>(next)->semaphoreType == vk::SemaphoreType::eTimeline;
     }
 
     VulkanSemaphore(const VulkanDevice& device)
         : VulkanSemaphore(device, vk::SemaphoreCreateInfo()) {}
 
+    /** Creates a timeline semaphore. The device must support timeline semaphores. */
+    VulkanSemaphore(const VulkanDevice& device, uint64_t initialValue)
+        : VulkanSemaphore(device, TimelineCreateInfo(device, initialValue)) {}
+
     ~VulkanSemaphore() = default;
 
     const vk::Semaphore& getHandle() const noexcept { return *handle; }
 
+    bool isTimeline() const noexcept { return timeline; }
+
+    /** The current counter value of a timeline semaphore. */
+    uint64_t getCounterValue() const noexcept
+    {
+        jassert(isTimeline() && getHandle());
+
+        vk::Result result;
+        uint64_t value = 0;
+
+        std::tie(result, value) = device.getHandle().getSemaphoreCounterValueKHR(getHandle()).asTuple();
+
+        PW_CHECK_VK_RESULT_SUCCESS(result, "Couldn't get semaphore counter value.");
+
+        return value;
+    }
+
+    /** Wait until the counter of a timeline semaphore reaches the value. */
+    bool wait(uint64_t value, juce::RelativeTime duration = juce::RelativeTime::seconds(1.0)) const noexcept
+    {
+        return waitForResult(value, duration) == vk::Result::eSuccess;
+    }
+
+    /** Returns eSuccess, eTimeout or the error of the wait, e.g. eErrorDeviceLost. */
+    vk::Result waitForResult(uint64_t value, juce::RelativeTime duration = juce::RelativeTime::seconds(1.0)) const noexcept
+    {
+        jassert(isTimeline() && getHandle());
+
+        const auto timeout = static_cast<uint64_t>(std::max<int64_t>(0, duration.inMilliseconds())) * 1000000; // Nano Seconds
+
+        const auto waitInfo = vk::SemaphoreWaitInfo()
+            .setSemaphoreCount(1)
+            .setPSemaphores(&getHandle())
+            .setPValues(&value);
+
+        const auto result = device.getHandle().waitSemaphoresKHR(waitInfo, timeout);
+
+        PW_CHECK_VK_RESULT(result == vk::Result::eSuccess || result == vk::Result::eTimeout, result, "Couldn't wait for semaphore.");
+
+        return result;
+    }
+
+    /** Set the counter of a timeline semaphore from the host. The value must be greater 
+        than the current value and than any pending signal operation. */
+    bool signal(uint64_t value) const noexcept
+    {
+        jassert(isTimeline() && getHandle());
+
+        const auto signalInfo = vk::SemaphoreSignalInfo()
+            .setSemaphore(getHandle())
+            .setValue(value);
+
+        const auto result = device.getHandle().signalSemaphoreKHR(signalInfo);
+
+        PW_CHECK_VK_RESULT_SUCCESS(result, "Couldn't signal semaphore.");
+
+        return result == vk::Result::eSuccess;
+    }
+
 private:
+    struct TimelineCreateInfo : public vk::SemaphoreCreateInfo
+    {
+        TimelineCreateInfo(const VulkanDevice& device, uint64_t initialValue)
+        {
+            jassert(device.supportsTimelineSemaphore());
+            juce::ignoreUnused(device);
+
+            typeInfo
+                .setSemaphoreType(vk::SemaphoreType::eTimeline)
+                .setInitialValue(initialValue);
+
+            setPNext(&typeInfo);
+        }
+
+        vk::SemaphoreTypeCreateInfo typeInfo;
+    };
+
+private:
+    const VulkanDevice& device;
     vk::UniqueSemaphore handle;
 
+    bool timeline = false;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VulkanSemaphore)
 };
 
@@ -51,7 +51,7 @@ public:
         vk::Result result;
 
         jassert(device.getHandle());
-        std::tie(result, handle) = device.getHandle().createShaderModuleUnique(createInfo).asTuple();
+        std::tie(result, handle) = device.getHandle().createShaderModuleUnique(createInfo, device.getAllocationCallbacks()).asTuple();
 
         PW_CHECK_VK_RESULT_SUCCESS(result, "Couldn't create shader module.");
     }
@@ -143,7 +143,7 @@ VulkanSwapchain::VulkanSwapchain(const VulkanDevice& device_, const VulkanSurfac
     vk::Result result;
 
     jassert(device.getHandle());
-    std::tie(result, handle) = device.getHandle().createSwapchainKHRUnique(createInfo).asTuple();
+    std::tie(result, handle) = device.getHandle().createSwapchainKHRUnique(createInfo, device.getAllocationCallbacks()).asTuple();
     
     PW_CHECK_VK_RESULT_SUCCESS(result, "Couldn't create swapchain.");
 
@@ -209,6 +209,132 @@ struct CachedImages : public juce::ReferenceCountedObject
         return nullptr;
     }
 
+    /** Under memory pressure, evict the least recently used textures that aren't referenced by any 
+        render pass, until at least the requested amount of bytes is released to the texture pools. 
+        Evicted textures are uploaded again the next time their image is drawn. 
+        Returns the number of bytes that were evicted. */
+    vk::DeviceSize evictTextures(vk::DeviceSize bytesToEvict)
+    {
+        struct EvictionCandidate
+        {
+            TextureCollection* collection;
+            VulkanTexture* texture;
+        };
+
+        juce::Array<EvictionCandidate> candidates;
+
+        for (auto collection : collections)
+        {
+            // The image of a texture can't be destroyed while the upload is still pending
+            if (collection->hasPendingTransfers())
+                continue;
+
+            for (auto texture : collection->textures)
+                if (texture->getReferenceCount() == 1)
+                    candidates.add({ collection, texture });
+        }
+
+        std::sort(candidates.begin(), candidates.end(), [](const EvictionCandidate& a, const EvictionCandidate& b)
+        {
+            return a.texture->getLastUsedTime() < b.texture->getLastUsedTime();
+        });
+
+        vk::DeviceSize evictedBytes = 0;
+
+        for (const auto& candidate : candidates)
+        {
+            if (evictedBytes >= bytesToEvict)
+                break;
+
+            evictedBytes += candidate.texture->getMemory().getMemorySize();
+            candidate.collection->evictTexture(*candidate.texture);
+        }
+
+        if (evictedBytes > 0)
+            PW_DBG_V("[Vulkan] Evicted " << juce::File::descriptionOfSizeInBytes(static_cast<juce::int64>(evictedBytes)) << " of textures.");
+
+        return evictedBytes;
+    }
+
+    /** Move the textures out of the blocks that are compacted by the texture pools. Only textures 
+        that aren't referenced by a render pass are moved. The copies are added to the submit batch 
+        of the frame, before any pass that samples the new textures, so they can be used immediately. 
+        Nothing is moved while no batch is set, a copy never costs a queue submit of its own. */
+    void relocateTextures(int maxNumMoves)
+    {
+        removeCompletedRelocations();
+
+        if (submitBatch == nullptr)
+            return;
+
+        for (auto collection : collections)
+        {
+            if (maxNumMoves <= 0)
+                break;
+
+            // The image of a texture can't be copied while the upload is still pending
+            if (collection->hasPendingTransfers())
+                continue;
+
+            for (int i = 0; i < collection->textures.size() && maxNumMoves > 0; ++i)
+            {
+                const auto texture = collection->textures.getObjectPointerUnchecked(i);
+                const auto& memory = texture->getMemory();
+
+                if (texture->getReferenceCount() == 1 && memory.getMemoryPool().isEvacuating(memory.getMemoryRange()))
+                {
+                    collection->relocateTexture(i);
+                    --maxNumMoves;
+                }
+            }
+        }
+    }
+
+    /** Submit the layout transitions of the linear textures, that were written since the last call, 
+        in one command buffer. Call it before any pass that might sample them is submitted. */
+    void submitPendingTransitions()
+    {
+        if (pendingTransitions.isEmpty())
+            return;
+
+        transitions.add(new TextureTransitions(device, pendingTransitions, submitBatch));
+        pendingTransitions.clearQuick();
+    }
+
+    /** Call before a pass is submitted. A pass that isn't part of the batch of the frame, e.g. 
+        of an immediate frame, might sample textures that were uploaded through the batch. 
+        So the batch is submitted first, without waiting for the end of the frame. */
+    void submitPendingTransfers(const VulkanSubmitBatch* passSubmitBatch)
+    {
+        submitPendingTransitions();
+
+        if (submitBatch != nullptr && submitBatch != passSubmitBatch)
+            submitBatch->submit(false);
+    }
+
+    /** The uploads of textures, while the batch is set, are submitted together with the passes 
+        of the frame. */
+    VulkanSubmitBatch* getSubmitBatch() const noexcept { return submitBatch; }
+
+    /** Sets the submit batch of the frame that is painted, for the lifetime of the object. */
+    struct ScopedSubmitBatch
+    {
+        ScopedSubmitBatch(CachedImages& owner_, VulkanSubmitBatch& batch) : owner(owner_)
+        {
+            jassert(owner.submitBatch == nullptr);
+            owner.submitBatch = &batch;
+        }
+
+        ~ScopedSubmitBatch()
+        {
+            owner.submitBatch = nullptr;
+        }
+
+        CachedImages& owner;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedSubmitBatch)
+    };
+
     const SingleImageSamplerDescriptor* getTextureDescriptor(const VulkanTexture& texture, juce::Graphics::ResamplingQuality quality)
     {
         auto textureSampler = getTextureSampler(texture);
@@ -280,6 +406,90 @@ private:
         }
     }
 
+    //==============================================================================
+    /** Copies the content of a texture into its relocated version. The source texture 
+        is referenced until the copy has completed. */
+    class TextureRelocation final : public VulkanCommandSequence
+    {
+    private:
+        TextureRelocation() = delete;
+
+    public:
+        TextureRelocation(const VulkanDevice& device_, VulkanTexture& source_, const VulkanTexture& destination, VulkanSubmitBatch* batch) :
+            VulkanCommandSequence(device_), source(&source_)
+        {
+            setSubmitBatch(batch);
+
+            const auto& srcImage = source->getMemory().getImage();
+            const auto& dstImage = destination.getMemory().getImage();
+
+            const auto subresource = vk::ImageSubresourceLayers()
+                .setAspectMask(vk::ImageAspectFlagBits::eColor)
+                .setMipLevel(0)
+                .setBaseArrayLayer(0)
+                .setLayerCount(1);
+
+            const auto region = vk::ImageCopy()
+                .setSrcSubresource(subresource)
+                .setDstSubresource(subresource)
+                .setExtent(srcImage.getExtent());
+
+            submit([&](const VulkanCommandBuffer& cb)
+            {
+                cb.transitionImageLayout(srcImage, vk::ImageLayout::eShaderReadOnlyOptimal, vk::ImageLayout::eTransferSrcOptimal);
+                cb.transitionImageLayout(dstImage, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal);
+                cb.copyImage(dstImage, srcImage, region);
+                cb.transitionImageLayout(dstImage, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
+            }, true);
+        }
+
+    private:
+        const VulkanTexture::Ptr source;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TextureRelocation)
+    };
+
+    void removeCompletedRelocations()
+    {
+        for (int i = relocations.size(); --i >= 0;)
+            if (relocations.getUnchecked(i)->isCompleted())
+                relocations.remove(i);
+    }
+
+    //==============================================================================
+    /** Transitions linear textures, that were written by the host, into the shader read only layout. 
+        The textures are referenced until the transitions have completed. */
+    class TextureTransitions final : public VulkanCommandSequence
+    {
+    private:
+        TextureTransitions() = delete;
+
+    public:
+        TextureTransitions(const VulkanDevice& device_, const juce::ReferenceCountedArray<VulkanTexture>& textures_, VulkanSubmitBatch* batch) :
+            VulkanCommandSequence(device_), textures(textures_)
+        {
+            setSubmitBatch(batch);
+
+            submit([&](const VulkanCommandBuffer& cb)
+            {
+                for (auto texture : textures)
+                    cb.transitionImageLayout(texture->getMemory().getImage(), vk::ImageLayout::ePreinitialized, vk::ImageLayout::eShaderReadOnlyOptimal);
+            }, true);
+        }
+
+    private:
+        const juce::ReferenceCountedArray<VulkanTexture> textures;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TextureTransitions)
+    };
+
+    void removeCompletedTransitions()
+    {
+        for (int i = transitions.size(); --i >= 0;)
+            if (transitions.getUnchecked(i)->isCompleted())
+                transitions.remove(i);
+    }
+
     //==============================================================================
     struct TextureCollection;
 
@@ -327,6 +537,8 @@ private:
 
         ~TextureCollection()
         {
+            releaseHostMemory();
+
             if (pixelData != nullptr)
                 pixelData->listeners.remove(this);
 
@@ -354,16 +566,41 @@ private:
             removeUnusedTextures();
         }
 
+        bool hasPendingTransfers() const noexcept
+        {
+            return transfers.size() > 0 || hostTransfers.size() > 0;
+        }
+
         void removeCompletedTransfers()
         {
             for (int i = transfers.size(); --i >= 0;)
             {
-                if (transfers[i]->getCompletedFence().wait())
+                if (transfers[i]->isCompleted())
                 {
                     transfers.remove(i);
                     stagingBuffers.remove(i);
                 }
             }
+
+            for (int i = hostTransfers.size(); --i >= 0;)
+                if (hostTransfers[i]->isCompleted())
+                    hostTransfers.remove(i);
+        }
+
+        /** The device reads the pixels of a host image directly, so they can't be changed 
+            or deleted before the copies have completed. */
+        void waitForHostTransfers()
+        {
+            for (auto transfer : hostTransfers)
+                transfer->waitForFence();
+
+            hostTransfers.clear();
+        }
+
+        void releaseHostMemory()
+        {
+            waitForHostTransfers();
+            hostMemory.reset();
         }
 
         void removeUnusedTextures()
@@ -393,10 +630,84 @@ private:
                 needReloading = true;
         }
 
+        void evictTexture(VulkanTexture& texture)
+        {
+            jassert(texture.getReferenceCount() == 1);
+
+            // Only the last texture represents the current pixel data
+            if (&texture == textures.getLast().get())
+                needReloading = true;
+
+            owner.disposeTextureSampler(texture);
+            textures.removeObject(&texture);
+        }
+
+        /** Replace the texture with a copy in a new memory range. */
+        void relocateTexture(int index)
+        {
+            VulkanTexture::Ptr texture = textures[index];
+            jassert(texture != nullptr && texture->getReferenceCount() == 2);
+
+            auto& memoryPool = texture->getMemory().getMemoryPool();
+
+            VulkanTexture::Ptr relocatedTexture = new VulkanTexture(owner.device, memoryPool, texture->getWidth(), texture->getHeight(), texture->isLinear());
+            relocatedTexture->setLastUsedTime(texture->getLastUsedTime());
+
+            owner.relocations.add(new TextureRelocation(owner.device, *texture, *relocatedTexture, owner.submitBatch));
+
+            // The descriptors of the relocated texture are created on the next use
+            owner.disposeTextureSampler(*texture);
+            textures.set(index, relocatedTexture);
+        }
+
+        /** Import the aligned pixel memory of a VulkanHostImageType image once. It stays 
+            imported until the pixel data is deleted. */
+        void importHostMemory(const juce::Image& image)
+        {
+            hostMemoryChecked = true;
+
+            void* data = nullptr;
+            size_t size = 0;
+
+            if (! VulkanHostImageType::getAllocation(image, data, size))
+                return;
+
+            if (! VulkanHostMemoryBuffer::canImport(owner.device, data, static_cast<vk::DeviceSize>(size)))
+                return;
+
+            std::unique_ptr<VulkanHostMemoryBuffer> buffer(new VulkanHostMemoryBuffer(owner.device, data, 
+                static_cast<vk::DeviceSize>(size), vk::BufferUsageFlagBits::eTransferSrc));
+
+            if (buffer->isValid())
+                hostMemory = std::move(buffer);
+        }
+
+        /** Copy the pixels straight from the imported memory into the image. Returns false if 
+            the image can't be imported, it's then uploaded with a staging buffer. */
+        bool copyFromHostMemory(const juce::Image& image, const VulkanImage& target)
+        {
+            if (! hostMemoryChecked)
+                importHostMemory(image);
+
+            if (hostMemory == nullptr)
+                return false;
+
+            const juce::Image::BitmapData bitmapData(image, juce::Image::BitmapData::readOnly);
+
+            if (! VulkanHostImageTransfer::canCopyBitmapData(*hostMemory, bitmapData))
+                return false;
+
+            auto transfer = hostTransfers.add(new VulkanHostImageTransfer(owner.device, target, *hostMemory));
+            transfer->setSubmitBatch(owner.submitBatch);
+            transfer->copyBitmapData(bitmapData);
+
+            return true;
+        }
+
         VulkanMemoryBuffer* createStagingBuffer(vk::DeviceSize bufferSize)
         {
             const auto createInfo = VulkanMemoryBuffer::CreateInfo()
-                .setHostVisible().setTransferSrc().setSize(bufferSize);
+                .setHostUpload().setTransferSrc().setSize(bufferSize);
 
             return stagingBuffers.add(new VulkanMemoryBuffer(owner.memory.stagingPool, createInfo));
         }
@@ -410,17 +721,32 @@ private:
                 const auto w = static_cast<uint32_t>(image.getWidth());
                 const auto h = static_cast<uint32_t>(image.getHeight());
 
-                auto& memoryPool = getTexturePool(owner.memory, w, h);
+                if (owner.memory.useLinearTexture(w, h))
+                {
+                    // Unified memory: write straight into the image, it only needs a layout transition
+                    texture = textures.add(new VulkanTexture(owner.device, owner.memory.linearTexturePool, w, h, true));
+                    texture->writeImage(image);
 
-                texture = textures.add(new VulkanTexture(owner.device, memoryPool, w, h));
+                    owner.pendingTransitions.add(texture);
+                }
+                else
+                {
+                    auto& memoryPool = getTexturePool(owner.memory, w, h);
 
-                auto stagingBuffer = createStagingBuffer(vk::DeviceSize(w * h * 4));
-                auto& imageBuffer = texture->getMemory();
+                    texture = textures.add(new VulkanTexture(owner.device, memoryPool, w, h));
 
-                auto transfer = transfers.add(new VulkanImageTransfer(owner.device, imageBuffer.getImage(), *stagingBuffer));                
-                
-                transfer->writeImage(image);
-                transfer->copyBufferToImage();
+                    auto& imageBuffer = texture->getMemory();
+
+                    if (! copyFromHostMemory(image, imageBuffer.getImage()))
+                    {
+                        auto stagingBuffer = createStagingBuffer(vk::DeviceSize(w * h * 4));
+                        auto transfer = transfers.add(new VulkanImageTransfer(owner.device, imageBuffer.getImage(), *stagingBuffer));                
+                        transfer->setSubmitBatch(owner.submitBatch);
+                    
+                        transfer->writeImage(image);
+                        transfer->copyBufferToImage();
+                    }
+                }
 
                 needReloading = false;
             }
@@ -444,12 +770,17 @@ private:
         {
             jassert(newPixelData == pixelData);
             ignoreUnused(newPixelData);
+
+            // The pixels are about to be written, while the device might still read them
+            waitForHostTransfers();
             
             needReloading = true;
         }
 
         void imageDataBeingDeleted(juce::ImagePixelData* /*newPixelData*/) override
         {
+            releaseHostMemory();
+
             owner.disposeCollection(*this);
 
             if (pixelData != nullptr)
@@ -467,6 +798,10 @@ private:
         juce::OwnedArray<VulkanMemoryBuffer> stagingBuffers;
         juce::OwnedArray<VulkanImageTransfer> transfers;
 
+        std::unique_ptr<VulkanHostMemoryBuffer> hostMemory;
+        juce::OwnedArray<VulkanHostImageTransfer> hostTransfers;
+        bool hostMemoryChecked = false;
+
         juce::Time lastUsed;
 
         bool needReloading = true;
@@ -478,6 +813,8 @@ private:
     {
         currentTime = juce::Time::getCurrentTime();
 
+        removeCompletedTransitions();
+
         for(auto& collection : collections)
             collection->clean();
 
@@ -511,6 +848,13 @@ private:
 
     juce::Array<TextureCollection*> disposedCollections;
 
+    juce::OwnedArray<TextureRelocation> relocations;
+
+    juce::ReferenceCountedArray<VulkanTexture> pendingTransitions;
+    juce::OwnedArray<TextureTransitions> transitions;
+
+    VulkanSubmitBatch* submitBatch = nullptr;
+
     juce::Time currentTime = juce::Time::getCurrentTime();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CachedImages)
@@ -49,57 +49,260 @@ private:
 
     static constexpr auto defaultNumIndices = 1024 * 6; // uint16 indices for 1024 quads
 
+    // Small buffers of the staging and vertex pool share one buffer per memory block
+    static constexpr auto stagingBufferUsage = vk::BufferUsageFlags(vk::BufferUsageFlagBits::eTransferSrc) | vk::BufferUsageFlagBits::eTransferDst;
+    static constexpr auto vertexBufferUsage = vk::BufferUsageFlags(vk::BufferUsageFlagBits::eVertexBuffer) | vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst;
+
+public:
+    struct Statistics final
+    {
+        juce::var toVar() const
+        {
+            auto object = new juce::DynamicObject();
+
+            object->setProperty("stagingPool", stagingPool.toVar());
+            object->setProperty("smallTexturePool", smallTexturePool.toVar());
+            object->setProperty("mediumTexturePool", mediumTexturePool.toVar());
+            object->setProperty("bigTexturePool", bigTexturePool.toVar());
+            object->setProperty("linearTexturePool", linearTexturePool.toVar());
+            object->setProperty("framebufferPool", framebufferPool.toVar());
+            object->setProperty("vertexPool", vertexPool.toVar());
+
+            juce::Array<juce::var> heaps;
+            for (const auto& budget : heapBudgets)
+            {
+                auto heap = new juce::DynamicObject();
+                heap->setProperty("budget", static_cast<juce::int64>(budget.budget));
+                heap->setProperty("usage", static_cast<juce::int64>(budget.usage));
+                
+                heaps.add(juce::var(heap));
+            }
+
+            object->setProperty("heaps", heaps);
+
+            return juce::var(object);
+        }
+
+        VulkanMemoryPool::Statistics stagingPool;
+        VulkanMemoryPool::Statistics smallTexturePool;
+        VulkanMemoryPool::Statistics mediumTexturePool;
+        VulkanMemoryPool::Statistics bigTexturePool;
+        VulkanMemoryPool::Statistics linearTexturePool;
+        VulkanMemoryPool::Statistics framebufferPool;
+        VulkanMemoryPool::Statistics vertexPool;
+
+        juce::Array<VulkanDevice::MemoryBudget> heapBudgets;
+    };
+
+    /** The bytes to preallocate in each pool, before the first frame is rendered. */
+    struct WarmUpProfile final
+    {
+        WarmUpProfile() = default;
+
+        /** Reserve the peaks of a previous session. */
+        explicit WarmUpProfile(const Statistics& statistics) noexcept :
+            stagingBytes(statistics.stagingPool.peakAllocatedBytes),
+            smallTextureBytes(statistics.smallTexturePool.peakAllocatedBytes),
+            mediumTextureBytes(statistics.mediumTexturePool.peakAllocatedBytes),
+            bigTextureBytes(statistics.bigTexturePool.peakAllocatedBytes),
+            linearTextureBytes(statistics.linearTexturePool.peakAllocatedBytes),
+            framebufferBytes(statistics.framebufferPool.peakAllocatedBytes),
+            vertexBytes(statistics.vertexPool.peakAllocatedBytes) {}
+
+        vk::DeviceSize stagingBytes = defaultPoolSize;
+        vk::DeviceSize smallTextureBytes = smallPoolSize;
+        vk::DeviceSize mediumTextureBytes = mediumPoolSize;
+        vk::DeviceSize bigTextureBytes = 0;
+        vk::DeviceSize linearTextureBytes = 0;
+        vk::DeviceSize framebufferBytes = 0;
+        vk::DeviceSize vertexBytes = smallPoolSize;
+    };
+
 public:
     CachedMemory() = delete;
 
-    explicit CachedMemory(const VulkanDevice& device) : 
-        stagingPool(device, defaultPoolSize),
+    explicit CachedMemory(const VulkanDevice& device_) : 
+        device(device_),
+        stagingPool(device, defaultPoolSize, stagingBufferUsage),
         smallTexturePool(device, smallPoolSize),
         mediumTexturePool(device, mediumPoolSize),
         bigTexturePool(device, bigPoolSize),
+        linearTexturePool(device, mediumPoolSize),
         framebufferPool(device, bigPoolSize),
-        vertexPool(device, smallPoolSize),
+        vertexPool(device, smallPoolSize, vertexBufferUsage),
         defaultQuadIndices(vertexPool, VulkanMemoryBuffer::CreateInfo()
-            .setSize<uint16_t>(defaultNumIndices).setDeviceLocal().setIndexBuffer().setTransferDst()) 
+            .setSize<uint16_t>(defaultNumIndices).setDeviceLocal().setIndexBuffer().setTransferDst().setPinned()) 
     {
+       // Rank the memory types by usage, e.g. vertices land in device local host visible memory if available
+       stagingPool.setMemoryIntent(VulkanMemoryUsage::Intent::staging);
+       smallTexturePool.setMemoryIntent(VulkanMemoryUsage::Intent::staticResource);
+       mediumTexturePool.setMemoryIntent(VulkanMemoryUsage::Intent::staticResource);
+       bigTexturePool.setMemoryIntent(VulkanMemoryUsage::Intent::staticResource);
+       linearTexturePool.setMemoryIntent(VulkanMemoryUsage::Intent::staticResource);
+       framebufferPool.setMemoryIntent(VulkanMemoryUsage::Intent::renderTarget);
+       vertexPool.setMemoryIntent(VulkanMemoryUsage::Intent::streamUpload);
+
        VulkanIndexBuffer<uint16_t>::generateQuadrilateralIndices(defaultQuadIndices, device, vertexPool, defaultNumIndices);
+
+       // Images are loaded and released on other threads than the render thread
+       stagingPool.setConcurrent(true);
+       smallTexturePool.setConcurrent(true);
+       mediumTexturePool.setConcurrent(true);
+       bigTexturePool.setConcurrent(true);
+       linearTexturePool.setConcurrent(true);
+
+       // Gradient lookup tables, icons and filmstrip frames mostly fit into a few size classes
+       smallTexturePool.setSlabSlotSizes({ 1024, 4096, 16384 });
+       mediumTexturePool.setSlabSlotSizes({ 65536, 262144 });
+
+       initialiseLinearTextures();
+    }
+
+    /** On unified memory, textures are written directly by the host instead of being copied 
+        from a staging buffer. Linear images might have a smaller maximum extent. */
+    bool useLinearTexture(uint32_t width, uint32_t height) const noexcept
+    {
+        return width <= maxLinearTextureExtent.width && height <= maxLinearTextureExtent.height;
+    }
+
+    /** Preallocate the blocks of the profile, so the first frames don't allocate device memory. 
+        The memory types are probed with resources of the same usage as the pool's resources. */
+    void warmUp(const WarmUpProfile& profile = WarmUpProfile())
+    {
+        const auto deviceLocal = vk::MemoryPropertyFlags(vk::MemoryPropertyFlagBits::eDeviceLocal);
+        const auto hostVisible = vk::MemoryPropertyFlags(vk::MemoryPropertyFlagBits::eHostVisible);
+
+        if (profile.stagingBytes > 0)
+        {
+            const VulkanBuffer probeBuffer(device, 1, stagingBufferUsage);
+            stagingPool.reserve(profile.stagingBytes, probeBuffer.getMemoryRequirements(), hostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+        }
+
+        if (profile.vertexBytes > 0)
+        {
+            const VulkanBuffer probeBuffer(device, 1, vertexBufferUsage);
+            vertexPool.reserve(profile.vertexBytes, probeBuffer.getMemoryRequirements(), hostVisible);
+        }
+
+        {
+            const VulkanImage probeImage(device, 1, 1, vk::Format::eB8G8R8A8Unorm, 
+                vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst);
+
+            const auto memoryRequirements = probeImage.getMemoryRequirements();
+
+            if (profile.smallTextureBytes > 0)
+                smallTexturePool.reserve(profile.smallTextureBytes, memoryRequirements, deviceLocal);
+
+            if (profile.mediumTextureBytes > 0)
+                mediumTexturePool.reserve(profile.mediumTextureBytes, memoryRequirements, deviceLocal);
+
+            if (profile.bigTextureBytes > 0)
+                bigTexturePool.reserve(profile.bigTextureBytes, memoryRequirements, deviceLocal);
+        }
+
+        if (profile.linearTextureBytes > 0 && maxLinearTextureExtent.width > 0)
+        {
+            const VulkanImage probeImage(device, VulkanMemoryImage::CreateInfo(1, 1, vk::Format::eB8G8R8A8Unorm)
+                .setSampled().setTransferDst().setLinearTiling().getImageCreateInfo());
+
+            linearTexturePool.reserve(profile.linearTextureBytes, probeImage.getMemoryRequirements(), deviceLocal | hostVisible);
+        }
+
+        if (profile.framebufferBytes > 0)
+        {
+            const VulkanImage probeImage(device, 1, 1, vk::Format::eB8G8R8A8Unorm, vk::ImageUsageFlagBits::eColorAttachment 
+                | vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc);
+
+            framebufferPool.reserve(profile.framebufferBytes, probeImage.getMemoryRequirements(), deviceLocal);
+        }
     }
 
+    /** Without forceMinimize, only the empty blocks above the high-water mark of each pool are 
+        released, at most once per second. A forced minimization releases all empty blocks, 
+        e.g. under memory pressure or if the context is detached. */
     void minimizeStorage(bool forceMinimize = false)
     {
         const auto time = juce::Time::getCurrentTime();
 
-        const auto duration = time - lastStorageCheck;
-        if (forceMinimize || duration.inSeconds() > 4.0)
+        if (forceMinimize)
         {
-            stagingPool.minimizeStorage();
+            for (auto pool : getPools())
+                pool->minimizeStorage();
 
-            smallTexturePool.minimizeStorage();
-            mediumTexturePool.minimizeStorage();
-            bigTexturePool.minimizeStorage();
+            lastStorageCheck = time;
+        }
+        else if ((time - lastStorageCheck).inSeconds() > 1.0)
+        {
+            for (auto pool : getPools())
+                pool->trimStorage();
+            
+            lastStorageCheck = time;
+        }
+    }
 
-            framebufferPool.minimizeStorage();
+    /** Compact one sparse block per pool at a time. The textures in a compacted block are moved 
+        by CachedImages, staging buffers and vertex rings are transient and leave the block by 
+        themselves. Resources that live as long as their owner, e.g. the default quad indices, 
+        frame attachments and pooled layer memory, are pinned and their blocks are skipped. */
+    void updateCompaction()
+    {
+        const auto time = juce::Time::getCurrentTime();
+        const auto beginCompaction = (time - lastCompactionCheck).inSeconds() > 1.0;
 
-            vertexPool.minimizeStorage();
+        for (auto pool : getPools())
+        {
+            if (pool->isCompacting())
+                pool->updateCompaction();
+            else if (beginCompaction)
+                pool->beginCompaction();
+        }
+
+        if (beginCompaction)
+            lastCompactionCheck = time;
+    }
+
+    /** Get the budget of the device local heap with the highest usage ratio. Textures, 
+        layers and framebuffers all live there, so it's the heap that runs out first. */
+    VulkanDevice::MemoryBudget getDeviceLocalBudget() const
+    {
+        const auto& memoryProperties = device.getPhysicalDevice().getMemoryProperties();
+        const auto budgets = device.getMemoryBudgets();
+
+        VulkanDevice::MemoryBudget deviceLocalBudget;
+
+        for (int i = 0; i < budgets.size(); ++i)
+        {
+            const auto& budget = budgets.getReference(i);
+
+            const auto isDeviceLocal = static_cast<bool>(memoryProperties.memoryHeaps[i].flags & vk::MemoryHeapFlagBits::eDeviceLocal);
             
-            lastStorageCheck = time;
+            if (isDeviceLocal && budget.getUsageRatio() >= deviceLocalBudget.getUsageRatio())
+                deviceLocalBudget = budget;
         }
+
+        return deviceLocalBudget;
     }
 
-    juce::String getSizeInBytes(const VulkanMemoryPool& pool)
+    Statistics getStatistics() const
     {
-        return juce::File::descriptionOfSizeInBytes(pool.size());
+        Statistics statistics;
+
+        statistics.stagingPool = stagingPool.getStatistics();
+        statistics.smallTexturePool = smallTexturePool.getStatistics();
+        statistics.mediumTexturePool = mediumTexturePool.getStatistics();
+        statistics.bigTexturePool = bigTexturePool.getStatistics();
+        statistics.linearTexturePool = linearTexturePool.getStatistics();
+        statistics.framebufferPool = framebufferPool.getStatistics();
+        statistics.vertexPool = vertexPool.getStatistics();
+
+        statistics.heapBudgets = device.getMemoryBudgets();
+
+        return statistics;
     }
 
-    void printUsage()
+    void printStatistics() const
     {
-        PW_DBG_V("[Vulkan] Cached Memory :"
-            << "\n\tStaging Pool: " << getSizeInBytes(stagingPool)
-            << "\n\tTexture Pool (Small): " << getSizeInBytes(smallTexturePool)
-            << "\n\tTexture Pool (Medium): " << getSizeInBytes(mediumTexturePool)
-            << "\n\tTexture Pool (Big): " << getSizeInBytes(bigTexturePool)
-            << "\n\tFramebuffer Pool: " << getSizeInBytes(framebufferPool)
-            << "\n\tVertex Pool: " << getSizeInBytes(vertexPool));
+        PW_DBG_V("[Vulkan] Cached Memory : " << juce::JSON::toString(getStatistics().toVar()));
     } 
 
     static CachedMemory* get(VulkanDevice& device)
@@ -115,12 +318,17 @@ public:
         return memory;
     }
 
+    const VulkanDevice& device;
+
     VulkanMemoryPool stagingPool;
 
     VulkanMemoryPool smallTexturePool;
     VulkanMemoryPool mediumTexturePool;
     VulkanMemoryPool bigTexturePool;
 
+    // Linear and optimal images are kept in different blocks, so they never share a page of bufferImageGranularity
+    VulkanMemoryPool linearTexturePool;
+
     VulkanMemoryPool framebufferPool;
 
     VulkanMemoryPool vertexPool;
@@ -130,7 +338,45 @@ public:
     VulkanMemoryBuffer defaultQuadIndices;
 
 private:
+    std::array<VulkanMemoryPool*, 7> getPools() noexcept
+    {
+        return { &stagingPool, &smallTexturePool, &mediumTexturePool, &bigTexturePool, &linearTexturePool, &framebufferPool, &vertexPool };
+    }
+
+    void initialiseLinearTextures()
+    {
+        const auto& physicalDevice = device.getPhysicalDevice();
+
+        if (! physicalDevice.hasUnifiedMemory())
+            return;
+
+        // The textures are sampled with linear filtering, which is optional for linear tiling
+        const auto requiredFeatures = vk::FormatFeatureFlagBits::eSampledImage | vk::FormatFeatureFlagBits::eSampledImageFilterLinear;
+        const auto formatProperties = physicalDevice.getHandle().getFormatProperties(vk::Format::eB8G8R8A8Unorm);
+
+        if ((formatProperties.linearTilingFeatures & requiredFeatures) != requiredFeatures)
+            return;
+
+        vk::Result result;
+        vk::ImageFormatProperties properties;
+
+        std::tie(result, properties) = physicalDevice.getHandle().getImageFormatProperties(vk::Format::eB8G8R8A8Unorm, vk::ImageType::e2D, 
+            vk::ImageTiling::eLinear, vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst);
+
+        // Not an error, the textures are just uploaded with a staging buffer
+        if (result != vk::Result::eSuccess)
+            return;
+
+        maxLinearTextureExtent = properties.maxExtent;
+
+        PW_DBG_V("Unified memory, textures up to " << juce::String(maxLinearTextureExtent.width) << " x " 
+            << juce::String(maxLinearTextureExtent.height) << " are written without staging buffers.");
+    }
+
     juce::Time lastStorageCheck;
+    juce::Time lastCompactionCheck;
+
+    vk::Extent3D maxLinearTextureExtent { 0, 0, 0 };
 
 private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CachedMemory)
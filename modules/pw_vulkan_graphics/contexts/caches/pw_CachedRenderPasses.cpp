@@ -50,48 +50,67 @@ struct OffscreenPassInfo : public vk::RenderPassCreateInfo
             .setPipelineBindPoint(vk::PipelineBindPoint::eGraphics)
             .setColorAttachments(colourAttachments);
 
-        // TODO: We could potentially add some more advanced render pass dependencies.
-        // Not sure if this is necessary for the general offscreen render case.
-
-        /*
+        // The attachment memory might have belonged to another image, e.g. an aliased layer or a 
+        // frame in flight, that was sampled before. The layout transition and the first writes 
+        // have to wait for these reads. A write-after-read hazard only needs an execution 
+        // dependency, so there is no source access. The reads cover any region of the image.
         dependencies[0]
             .setSrcSubpass(VK_SUBPASS_EXTERNAL)
             .setDstSubpass(0)
             .setSrcStageMask(vk::PipelineStageFlagBits::eFragmentShader)
             .setDstStageMask(vk::PipelineStageFlagBits::eColorAttachmentOutput)
-            .setSrcAccessMask(vk::AccessFlagBits::eShaderRead)
-            .setDstAccessMask(vk::AccessFlagBits::eColorAttachmentWrite)
-            .setDependencyFlags(vk::DependencyFlagBits::eByRegion);
+            .setSrcAccessMask({})
+            .setDstAccessMask(vk::AccessFlagBits::eColorAttachmentWrite);
 
-        dependencies[1]
-            .setSrcSubpass(0)
-            .setDstSubpass(VK_SUBPASS_EXTERNAL)
-            .setSrcStageMask(vk::PipelineStageFlagBits::eColorAttachmentOutput)
-            .setDstStageMask(vk::PipelineStageFlagBits::eFragmentShader)
-            .setSrcAccessMask(vk::AccessFlagBits::eColorAttachmentWrite)
-            .setDstAccessMask(vk::AccessFlagBits::eShaderRead)
-            .setDependencyFlags(vk::DependencyFlagBits::eByRegion);
-        */
+        setAttachments(attachments);
+        setSubpasses(subpasses);
+        setDependencies(dependencies);
+    }
+
+    vk::Format colourFormat;
+
+    std::array<vk::AttachmentReference, 1> colourAttachments = 
+    { 
+        vk::AttachmentReference(0, vk::ImageLayout::eColorAttachmentOptimal) 
+    };
+
+    std::array<vk::AttachmentDescription, 1> attachments;
+    std::array<vk::SubpassDescription, 1> subpasses;
+    std::array<vk::SubpassDependency, 1> dependencies;
+};
+
+//==============================================================================
+/** Continues an offscreen pass that has ended, e.g. to execute secondary command buffers. 
+    The content of the framebuffer is loaded and the writes of the previous pass are visible. */
+struct OffscreenContinuePassInfo : public vk::RenderPassCreateInfo
+{
+    OffscreenContinuePassInfo(vk::Format format) : colourFormat(format)
+    {
+        auto& colorAttachment = attachments[0];
+        auto& subpass = subpasses[0];
+
+        colorAttachment
+            .setFormat(colourFormat)
+            .setSamples(vk::SampleCountFlagBits::e1)
+            .setLoadOp(vk::AttachmentLoadOp::eLoad)
+            .setStoreOp(vk::AttachmentStoreOp::eStore)
+            .setStencilLoadOp(vk::AttachmentLoadOp::eDontCare)
+            .setStencilStoreOp(vk::AttachmentStoreOp::eDontCare)
+            .setInitialLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
+            .setFinalLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+
+        subpass
+            .setPipelineBindPoint(vk::PipelineBindPoint::eGraphics)
+            .setColorAttachments(colourAttachments);
 
-        /*
         dependencies[0]
             .setSrcSubpass(VK_SUBPASS_EXTERNAL)
             .setDstSubpass(0)
-            .setSrcStageMask(vk::PipelineStageFlagBits::eBottomOfPipe)
+            .setSrcStageMask(vk::PipelineStageFlagBits::eColorAttachmentOutput)
             .setDstStageMask(vk::PipelineStageFlagBits::eColorAttachmentOutput)
-            .setSrcAccessMask(vk::AccessFlagBits::eMemoryRead)
+            .setSrcAccessMask(vk::AccessFlagBits::eColorAttachmentWrite)
             .setDstAccessMask(vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite)
             .setDependencyFlags(vk::DependencyFlagBits::eByRegion);
-          
-        dependencies[1]
-            .setSrcSubpass(0)
-            .setDstSubpass(VK_SUBPASS_EXTERNAL)
-            .setSrcStageMask(vk::PipelineStageFlagBits::eColorAttachmentOutput)
-            .setDstStageMask(vk::PipelineStageFlagBits::eBottomOfPipe)
-            .setSrcAccessMask(vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite)
-            .setDstAccessMask(vk::AccessFlagBits::eMemoryRead)
-            .setDependencyFlags(vk::DependencyFlagBits::eByRegion);
-        */
 
         setAttachments(attachments);
         setSubpasses(subpasses);
@@ -107,7 +126,7 @@ struct OffscreenPassInfo : public vk::RenderPassCreateInfo
 
     std::array<vk::AttachmentDescription, 1> attachments;
     std::array<vk::SubpassDescription, 1> subpasses;
-    std::array<vk::SubpassDependency, 0> dependencies;
+    std::array<vk::SubpassDependency, 1> dependencies;
 };
 
 //==============================================================================
@@ -161,6 +180,7 @@ struct CachedRenderPasses : public juce::ReferenceCountedObject
     
     CachedRenderPasses(const VulkanDevice& device, vk::Format format) : 
         offscreen(device, RenderPass::OffscreenPassInfo(format)),
+        offscreenContinue(device, RenderPass::OffscreenContinuePassInfo(format)),
         swapchain(device, RenderPass::SwapchainPassInfo(format)) {}
 
     static CachedRenderPasses* get(VulkanDevice& device, vk::Format format)
@@ -181,6 +201,7 @@ struct CachedRenderPasses : public juce::ReferenceCountedObject
     }
 
     VulkanRenderPass offscreen;
+    VulkanRenderPass offscreenContinue;
     VulkanRenderPass swapchain;
 };
 
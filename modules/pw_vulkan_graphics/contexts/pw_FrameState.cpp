@@ -30,8 +30,8 @@ namespace parawave
 class FrameState : public RenderLayer
 {
 public:
-    FrameState(DeviceState& deviceState, uint32_t width, uint32_t height, vk::Format format) :
-        RenderLayer(deviceState, width, height, format), renderCache(std::make_unique<RenderCache>(deviceState))
+    FrameState(DeviceState& deviceState, const VulkanCommandPool& commandPool, uint32_t width, uint32_t height, vk::Format format) :
+        RenderLayer(deviceState, commandPool, width, height, format), renderCache(std::make_unique<RenderCache>(deviceState, commandPool))
     {
         setCache(renderCache.get());
     }
@@ -43,6 +43,10 @@ public:
         quadQueue.reset();
     }
 
+    void trimFreeLayers() { renderCache->trimFreeLayers(); }
+
+    void releaseFreeLayers() { renderCache->releaseFreeLayers(); }
+
 private:
     std::unique_ptr<RenderCache> renderCache;
 
@@ -51,36 +55,45 @@ private:
 };
 
 //==============================================================================
-/** Holds a frame state and can be used to immediately render to it using a fence at the end as sync. */
+/** Holds a frame state and can be used to immediately render to it using a fence at the end as sync. 
+    The frame and its layers are submitted in a batch of their own, which uses the timeline of the 
+    device instead of the fence if available. */
 class ImmediateFrameState
 {
 public:
     ImmediateFrameState(const VulkanContext& context_, uint32_t width, uint32_t height, bool shouldClearImage, vk::Format renderFormat) :
         context(context_), 
         deviceState(*context.getDevice(), renderFormat),
-        frame(deviceState, width, height, renderFormat),
-        fence(deviceState.device), renderClearFlag(shouldClearImage) {}
+        commandPool(deviceState.device, deviceState.device.getGraphicsQueue().familyIndex, vk::CommandPoolCreateFlagBits::eTransient),
+        frame(deviceState, commandPool, width, height, renderFormat),
+        submitBatch(deviceState.device), renderClearFlag(shouldClearImage) 
+    {
+        frame.setSubmitBatch(&submitBatch);
+    }
 
     ~ImmediateFrameState()
     {
         deviceState.setMinimizeStorageOnRelease(false);
 
         /** If the Immediate State is deleted, but the fence not completed, we still have to wait
-            for it to complete. */
-        if ( !fenceCompleted)
+            for it to complete. If the device was lost, it never will. */
+        if (! fenceCompleted && ! submitBatch.waitIdle())
         {
-            fence.waitIdle();
+            PW_DBG_V("[Vulkan] Couldn't wait for render fence. The device might be lost.");
         }
     }
 
     void startRender()
     {
-        if (fence.wait())
+        if (submitBatch.waitForCompletion())
         {
             // Immediate rendering doesn't wait for previous submits and will not signal !
             frame.setWaitSemaphore(nullptr);
             frame.setSignalSemaphore(nullptr);
 
+            // All command buffers of the last flush have completed
+            commandPool.reset();
+
             frame.reset();
             frame.beginRender(renderClearFlag);
 
@@ -101,15 +114,15 @@ public:
 
         frame.endRender();
 
-        if (! fence.reset())
-            return;
-
         fenceCompleted = false;
 
-        const auto result = frame.submit(fence);
+        auto result = frame.submit();
+        if (result == vk::Result::eSuccess)
+            result = submitBatch.submit(true);
+
         if (result == vk::Result::eSuccess)
         {
-            if (fence.wait())
+            if (submitBatch.waitForCompletion())
             {
                 fenceCompleted = true;
             }
@@ -141,8 +154,10 @@ public:
     const VulkanContext& context;
     DeviceState deviceState;
 
+    const VulkanCommandPool commandPool;
+
     FrameState frame;
-    VulkanFence fence;
+    VulkanSubmitBatch submitBatch;
 
     bool renderStartedFlag = false;
     bool renderClearFlag = false;
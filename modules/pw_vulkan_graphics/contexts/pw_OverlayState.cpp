@@ -57,11 +57,11 @@ private:
     using VertexType = PixelVertex;
     
 public:
-    OverlayState(const DeviceState& deviceState) :
+    OverlayState(const DeviceState& deviceState, const VulkanCommandPool& commandPool) :
         state(deviceState),
-        commandBuffer(state.device), completedSemaphore(state.device),
+        commandBuffer(state.device, commandPool), completedSemaphore(state.device),
         vertices(state.memory.vertexPool, VulkanMemoryBuffer::CreateInfo()
-            .setSize<VertexType>(numVertices).setHostVisible().setVertexBuffer()),
+            .setSize<VertexType>(numVertices).setHostVisible().setVertexBuffer().setPinned()),
         sampler(state.device),
         descriptor(state.images.getImageSamplerDescriptorPool()) {}
 
@@ -72,7 +72,6 @@ public:
 
     void beginRender(const SwapchainFrame& frame) noexcept
     {
-        commandBuffer.reset();
         commandBuffer.begin();
 
         const auto renderBounds = frame.swapchainImage.getBounds();
@@ -97,7 +96,7 @@ public:
         setParameters(screenBounds.getWidth(), screenBounds.getHeight(), screenBounds);
         setVertices(screenBounds);
 
-        commandBuffer.bindVertexBuffer(vertices.getBuffer());
+        commandBuffer.bindVertexBuffer(vertices);
 
         commandBuffer.draw(numVertices);
     }
@@ -109,16 +108,10 @@ public:
         commandBuffer.end();
     }
 
-    vk::Result submit(const VulkanSemaphore& waitSemaphore, const VulkanFence& completedFence) const noexcept
+    /** Add the overlay as last command buffer of the frame. The batch must be submitted before the image is presented. */
+    void submit(const VulkanSemaphore& waitSemaphore, VulkanSubmitBatch& submitBatch) const
     {
-        auto submitInfo = VulkanCommandSequence::SingleWaitSignalSubmit(commandBuffer);
-
-        submitInfo.setWaitSemaphore(waitSemaphore);
-        submitInfo.setSignalSemaphore(completedSemaphore);
-        
-        const auto result = state.device.getGraphicsQueue().submit(submitInfo, completedFence.getHandle());
-
-        return result;
+        submitBatch.add(commandBuffer, &waitSemaphore, &completedSemaphore);
     }
 
 private:
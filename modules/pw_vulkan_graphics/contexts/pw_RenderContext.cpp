@@ -28,15 +28,35 @@ namespace parawave
 
 //==============================================================================
 /** A RenderContext manages the state of one active VulkanContext and holds the swapchain frames
-    and acquire one frame per render cycle. */
+    and acquire one frame per render cycle. 
+
+    All command buffers of a frame, the texture uploads, the layers, the frame and the overlay, 
+    are collected in the submit batch of the frame and submitted with a single vkQueueSubmit. 
+    The fence of the batch, or its value on the device timeline, signals the completion 
+    of the frame.
+
+    Several frames can be in flight, so the components of the next frame are painted while the 
+    device still renders the previous ones. Every frame owns its framebuffer, overlay, 
+    semaphores, submit batch and a transient command pool for the command buffers of its passes.
+
+    The render cache of a frame holds its vertices, layers, descriptors, gradient textures and 
+    the references to sampled textures. It's only reset after the fence of the frame has 
+    signaled, so nothing the device might still read is released before.
+
+    With a thread pool for the recorders, every frame also owns a VulkanParallelRecorder. Its 
+    secondary command buffers are executed in the framebuffer of the frame, after the painted 
+    content, and its command pools are reset together with the command pool of the frame. */
 class RenderContext : public DeviceState
 {
 public:
     using FrameType = FrameState;
     using OverlayType = OverlayState;
 
-private:
-    static constexpr uint32_t maxFramesInFlight = 1;
+    enum
+    {
+        defaultNumFramesInFlight = 2,
+        maxNumFramesInFlight = 3
+    };
 
 public:
     enum class DrawStatus
@@ -47,26 +67,35 @@ public:
     };
 
 public:
-    RenderContext(VulkanDevice& device, const VulkanSwapchain& swapchain_) : 
-        DeviceState(device, swapchain_.getImageFormat()), swapchain(swapchain_)
+    RenderContext(VulkanDevice& device, const VulkanSwapchain& swapchain_, int numFramesInFlight_ = defaultNumFramesInFlight, 
+        juce::ThreadPool* recorderThreads = nullptr) : 
+        DeviceState(device, swapchain_.getImageFormat()), swapchain(swapchain_), 
+        numFramesInFlight(static_cast<size_t>(juce::jlimit(1, static_cast<int>(maxNumFramesInFlight), numFramesInFlight_)))
     {
         // In case the RenderContext is recreated, minimize the storage used by previous allocations!
         minimizeStorage();
 
         // Per Frame Resources
-        for (auto i = 0U; i < maxFramesInFlight; ++i)
+        for (auto i = 0U; i < numFramesInFlight; ++i)
         {
             imageAcquiredSemaphores.add(new VulkanSemaphore(device));
-            imageCompletedFences.add(new VulkanFence(device));
+            submitBatches.add(new VulkanSubmitBatch(device));
+            commandPools.add(new VulkanCommandPool(device, device.getGraphicsQueue().familyIndex, vk::CommandPoolCreateFlagBits::eTransient));
+
+            if (recorderThreads != nullptr)
+                recorders.add(new VulkanParallelRecorder(device, *recorderThreads));
         }
 
         const auto frameBufferFormat = swapchain.getImageFormat();
 
-        for (auto i = 0U; i < maxFramesInFlight; ++i)
-            frames.add(new FrameType(*this, swapchain.getWidth(), swapchain.getHeight(), frameBufferFormat));
+        for (auto i = 0U; i < numFramesInFlight; ++i)
+        {
+            auto frame = frames.add(new FrameType(*this, *commandPools[static_cast<int>(i)], swapchain.getWidth(), swapchain.getHeight(), frameBufferFormat));
+            frame->setSubmitBatch(submitBatches[static_cast<int>(i)]);
+        }
 
-        for (auto i = 0U; i < maxFramesInFlight; ++i)
-            overlays.add(new OverlayType(*this));
+        for (auto i = 0U; i < numFramesInFlight; ++i)
+            overlays.add(new OverlayType(*this, *commandPools[static_cast<int>(i)]));
 
         //==============================================================================
         // Swapchain Images : There can be more swapchain framebuffers than "images in flight" !
@@ -75,6 +104,8 @@ public:
         for (auto i = 0U; i < numSwapchainFrames; ++i)
             swapchainFrames.add(new SwapchainFrame(swapchain, i, renderPasses.swapchain));
 
+        swapchainImageBatches.insertMultiple(0, nullptr, static_cast<int>(numSwapchainFrames));
+
         //==============================================================================
         PW_DBG_V("Created render context.");
     }
@@ -87,7 +118,17 @@ public:
         PW_DBG_V("Destroyed render context."); 
     }
 
-    DrawStatus drawFrame(std::function<void(FrameType& frame)> drawComponents = nullptr)
+    int getNumFramesInFlight() const noexcept { return static_cast<int>(numFramesInFlight); }
+
+    /** The index of the frame that is painted by the next drawFrame() call. Every frame keeps 
+        the content of its own framebuffer, which was last rendered numFramesInFlight frames ago. */
+    int getCurrentFrameIndex() const noexcept { return static_cast<int>(currentFrameIndex); }
+
+    /** The recordFrame function is only called if the context has recorders. It records into the 
+        secondary command buffers of the recorder, with the offscreen continue pass and the 
+        framebuffer of the frame. */
+    DrawStatus drawFrame(std::function<void(FrameType& frame)> drawComponents = nullptr, 
+        std::function<void(FrameType& frame, VulkanParallelRecorder& recorder)> recordFrame = nullptr)
     {
         // return DrawStatus::hasFinished;
 
@@ -98,20 +139,22 @@ public:
         }
            
         const auto renderIndex = static_cast<int>(currentFrameIndex);       
-        const auto& imageCompletedFence = *imageCompletedFences[renderIndex];
+        auto& submitBatch = *submitBatches[renderIndex];
 
         // If the frame is still in flight, wait for the corresponding render fence
-        if (! imageCompletedFence.wait()) // TODO : fence wait timeout ?
+        if (! submitBatch.waitForCompletion()) // TODO : fence wait timeout ?
         {
             //jassertfalse;
             return DrawStatus::hasFailed; 
         }
-            
-        if (! imageCompletedFence.reset())
-        {
-            jassertfalse;
-            return DrawStatus::hasFailed; 
-        }
+
+        // All command buffers of the frame have completed, reset them at once and keep their memory
+        commandPools[renderIndex]->reset();
+
+        auto recorder = recorders[renderIndex];
+
+        if (recorder != nullptr)
+            recorder->reset();
             
         uint32_t swapchainImageIndex = 0;
 
@@ -134,6 +177,23 @@ public:
             }
         }
 
+        //==============================================================================
+        // The swapchain can return an image that is still used by another frame in flight
+        {
+            auto& swapchainImageBatch = swapchainImageBatches.getReference(static_cast<int>(swapchainImageIndex));
+
+            if (swapchainImageBatch != nullptr && swapchainImageBatch != &submitBatch)
+            {
+                if (! swapchainImageBatch->waitForCompletion())
+                    return DrawStatus::hasFailed;
+            }
+
+            swapchainImageBatch = &submitBatch;
+        }
+
+        // Texture uploads during the painting are added to the batch of the frame
+        const CachedImages::ScopedSubmitBatch scopedSubmitBatch(images, submitBatch);
+
         //==============================================================================
         auto& frame = *frames[renderIndex];
 
@@ -151,7 +211,10 @@ public:
             if (drawComponents != nullptr)
                 drawComponents(frame);
 
-            frame.endRender();
+            if (recorder != nullptr && recordFrame != nullptr)
+                recordFrame(frame, *recorder);
+
+            frame.endRender(recorder);
 
             const auto result = frame.submit();
             if (result != vk::Result::eSuccess)
@@ -176,7 +239,13 @@ public:
             overlay.render(frame.getAttachment().imageView);
             overlay.endRender();
 
-            const auto result = overlay.submit(waitSemaphore, imageCompletedFence);
+            overlay.submit(waitSemaphore, submitBatch);
+        }
+
+        //==============================================================================
+        // Submit all command buffers of the frame, the fence is only reset once the frame is complete
+        {
+            const auto result = submitBatch.submit(true);
             if (result != vk::Result::eSuccess)
             {
                 jassertfalse;
@@ -215,22 +284,45 @@ public:
         return DrawStatus::hasFinished;
     }
 
+    /** Release the pooled layers of the frames that weren't used for a while. The layers are 
+        also trimmed when a frame is drawn, but this works for an idle context as well. */
+    void trimFreeLayers()
+    {
+        for (auto frame : frames)
+            frame->trimFreeLayers();
+    }
+
+    /** Release the pooled layers of all frames, so the blocks their attachments pin can be freed. */
+    void releaseFreeLayers()
+    {
+        for (auto frame : frames)
+            frame->releaseFreeLayers();
+    }
+
 private:
     void incrementFrameIndex()
     {
-        currentFrameIndex = (currentFrameIndex + 1) % maxFramesInFlight;
+        currentFrameIndex = (currentFrameIndex + 1) % numFramesInFlight;
     }
 
 private:
     const VulkanSwapchain& swapchain;
+    const size_t numFramesInFlight;
 
     juce::OwnedArray<VulkanSemaphore> imageAcquiredSemaphores;
-    juce::OwnedArray<VulkanFence> imageCompletedFences;
+    juce::OwnedArray<VulkanSubmitBatch> submitBatches;
+
+    // Declared before the frames and overlays, whose command buffers are allocated from them
+    juce::OwnedArray<VulkanCommandPool> commandPools;
+    juce::OwnedArray<VulkanParallelRecorder> recorders;
     
     juce::OwnedArray<FrameType> frames;
     juce::OwnedArray<OverlayType> overlays;
 
     juce::OwnedArray<SwapchainFrame> swapchainFrames;
+
+    // The batch of the frame that last rendered into the swapchain image
+    juce::Array<VulkanSubmitBatch*> swapchainImageBatches;
     
     size_t currentFrameIndex = 0;
     uint64_t frameCounter = 0;
@@ -49,7 +49,7 @@ public:
 
     bool invalidateAll() override
     {
-        validArea.clear();
+        clearValidAreas();
         
         triggerRepaint();
         return false;
@@ -58,7 +58,11 @@ public:
     bool invalidate(const juce::Rectangle<int>& area) override
     {
         const auto transform = getPaintTransform();
-        validArea.subtract (area.toFloat().transformedBy(transform).getSmallestIntegerContainer());
+        const auto invalidArea = area.toFloat().transformedBy(transform).getSmallestIntegerContainer();
+
+        // Every frame in flight has its own framebuffer, which has to catch up with the change
+        for (auto& validArea : validAreas)
+            validArea.subtract(invalidArea);
         
         triggerRepaint();
         return false;
@@ -128,7 +132,12 @@ public:
         {
             auto status = r->drawFrame([&](RenderContext::FrameType& frame)
             {
+                relocateTextures();
                 paintComponent(frame);
+            },
+            [&](RenderContext::FrameType& frame, VulkanParallelRecorder& recorder)
+            {
+                context.parallelRenderer->renderFrame(recorder, r->renderPasses.offscreenContinue, frame.getFramebuffer(), frame.getBounds());
             });
 
             switch (status)
@@ -146,6 +155,9 @@ public:
 
         checkSwapchainRecreation();
 
+        checkMemoryPressure();
+        updateMemoryCompaction();
+
         renderingFlag = false;
 
         checkFullscreenChange();
@@ -179,6 +191,9 @@ public:
 
         const auto viewportArea = frame.getBounds();
 
+        // The framebuffer of the frame still holds the content it had numFramesInFlight frames ago
+        auto& validArea = validAreas.getReference(renderContext->getCurrentFrameIndex());
+
         juce::RectangleList<int> invalid(viewportArea);
         invalid.subtract(validArea);
         validArea = viewportArea;
@@ -250,10 +265,31 @@ private:
             const auto createInfo = getSwapchainCreateInfo();
 
             swapchain.reset(new VulkanSwapchain(*cd, *surface, createInfo));
-            renderContext.reset(new RenderContext(*cd, *swapchain));
+            createRenderContext(*cd);
+
+            // Preallocate the memory pools, so the first frames don't stall on device memory allocations
+            CachedMemory::get(*cd)->warmUp();
         }
     }
 
+    void createRenderContext(VulkanDevice& cd)
+    {
+        if (context.parallelRenderer != nullptr && recorderThreads == nullptr)
+            recorderThreads = std::make_unique<juce::ThreadPool>(juce::jmax(1, juce::SystemStats::getNumCpus() - 1));
+
+        renderContext.reset(new RenderContext(cd, *swapchain, context.numFramesInFlight, recorderThreads.get()));
+
+        // The framebuffers of the new frames are empty
+        validAreas.clearQuick();
+        validAreas.resize(renderContext->getNumFramesInFlight());
+    }
+
+    void clearValidAreas()
+    {
+        for (auto& validArea : validAreas)
+            validArea.clear();
+    }
+
     void recreateSwapchain()
     {
         renderContext.reset();
@@ -271,9 +307,7 @@ private:
             if (createInfo.isValid())
             {
                 swapchain.reset(new VulkanSwapchain(*cd, *surface, createInfo));
-                renderContext.reset(new RenderContext(*cd, *swapchain));
-
-                validArea.clear();
+                createRenderContext(*cd);
 
                 needsSwapchainRecreation = false;
             }
@@ -288,6 +322,87 @@ private:
         }
     }
 
+    /** Query the heap budget a few times per second. If the usage exceeds the pressure threshold, 
+        release the least recently used textures, the pooled layers and the empty blocks of all 
+        memory pools, which includes the storage of retired layers and framebuffers. */
+    void checkMemoryPressure()
+    {
+        const auto time = juce::Time::getMillisecondCounter();
+        if (time - lastMemoryPressureCheck < memoryPressureCheckInterval)
+            return;
+
+        lastMemoryPressureCheck = time;
+
+        // Pooled layers that weren't used for a while are released, even if no frame was drawn
+        if (renderContext != nullptr)
+            renderContext->trimFreeLayers();
+
+        auto cd = context.device.get();
+        if (cd == nullptr)
+            return;
+
+        CachedMemory::Ptr memory = CachedMemory::get(*cd);
+
+        const auto budget = memory->getDeviceLocalBudget();
+        const auto usage = budget.getUsageRatio();
+
+        auto pressure = MemoryPressure::normal;
+
+        if (usage >= criticalPressureUsage)
+            pressure = MemoryPressure::critical;
+        else if (usage >= moderatePressureUsage)
+            pressure = MemoryPressure::moderate;
+
+        if (pressure != MemoryPressure::normal)
+        {
+            const auto targetUsage = static_cast<vk::DeviceSize>(static_cast<double>(budget.budget) * moderatePressureUsage);
+            
+            const auto bytesToEvict = pressure == MemoryPressure::critical ? std::numeric_limits<vk::DeviceSize>::max() 
+                : budget.usage - juce::jmin(budget.usage, targetUsage);
+
+            CachedImages::Ptr images = CachedImages::get(*cd, *memory);
+            images->evictTextures(bytesToEvict);
+
+            // The attachments of pooled layers are pinned, their blocks can only be freed without them
+            if (renderContext != nullptr)
+                renderContext->releaseFreeLayers();
+
+            memory->minimizeStorage(true);
+        }
+
+        if (pressure != context.memoryPressure)
+        {
+            context.memoryPressure = pressure;
+            context.memoryPressureListeners.call([&](MemoryPressureListener& l) { l.memoryPressureChanged(context, pressure); });
+        }
+    }
+
+    /** Move a few textures per frame out of sparse memory blocks, so they can be released. Called 
+        before the frame is painted, so the copies are part of the submit batch of the frame. */
+    void relocateTextures()
+    {
+        if (auto cd = context.device.get())
+        {
+            CachedMemory::Ptr memory = CachedMemory::get(*cd);
+            CachedImages::Ptr images = CachedImages::get(*cd, *memory);
+
+            images->relocateTextures(maxNumTextureMovesPerFrame);
+        }
+    }
+
+    /** Release the compacted blocks, once the textures have left them. Empty blocks above the 
+        high-water marks of the pools are trimmed once per second. */
+    void updateMemoryCompaction()
+    {
+        if (auto cd = context.device.get())
+        {
+            CachedMemory::Ptr memory = CachedMemory::get(*cd);
+
+            memory->updateCompaction();
+            memory->minimizeStorage();
+        }
+    }
+
     void checkFullscreenChange()
     {
         if (!needsFullscreenChange)
@@ -319,9 +434,13 @@ private:
     std::unique_ptr<VulkanSurface> surface;
 
     std::unique_ptr<VulkanSwapchain> swapchain;
+
+    // Shared by the recorders of all frames, declared before the render context that owns them
+    std::unique_ptr<juce::ThreadPool> recorderThreads;
     std::unique_ptr<RenderContext> renderContext;
 
-    juce::RectangleList<int> validArea;
+    // The area of every frame in flight, that is still up to date in its framebuffer
+    juce::Array<juce::RectangleList<int>> validAreas;
 
     bool needsSwapchainRecreation = false;
     bool needsFullscreenChange = false;
@@ -329,6 +448,14 @@ private:
     bool renderingFlag = false;
     bool fullscreenFlag = false;
 
+    static constexpr float moderatePressureUsage = 0.8f;
+    static constexpr float criticalPressureUsage = 0.95f;
+
+    static constexpr juce::uint32 memoryPressureCheckInterval = 250; // ms
+    juce::uint32 lastMemoryPressureCheck = 0;
+
+    static constexpr int maxNumTextureMovesPerFrame = 4;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CachedImage)
 };
 
@@ -380,7 +507,7 @@ public:
             cachedMemory->minimizeStorage(true);
 
             #if(JUCE_DEBUG == 1)
-            cachedMemory->printUsage();
+            cachedMemory->printStatistics();
             #endif
         } 
     }
@@ -570,6 +697,34 @@ void VulkanContext::setPresentMode(vk::PresentModeKHR preferredPresentMode)
     presentMode = preferredPresentMode;
 }
 
+void VulkanContext::setNumFramesInFlight(int numFrames)
+{
+    // This method must not be called when the context has already been attached!
+    // Call it before attaching your context, or use detach() first, before calling this!
+    jassert(! attachment);
+
+    numFramesInFlight = juce::jlimit(1, static_cast<int>(RenderContext::maxNumFramesInFlight), numFrames);
+}
+
+int VulkanContext::getNumFramesInFlight() const noexcept
+{
+    return numFramesInFlight;
+}
+
+void VulkanContext::setParallelRenderer(ParallelRenderer* newRenderer)
+{
+    // This method must not be called when the context has already been attached!
+    // Call it before attaching your context, or use detach() first, before calling this!
+    jassert(! attachment);
+
+    parallelRenderer = newRenderer;
+}
+
+VulkanContext::ParallelRenderer* VulkanContext::getParallelRenderer() const noexcept
+{
+    return parallelRenderer;
+}
+
 void VulkanContext::setPhysicalDevice(const VulkanPhysicalDevice& physicalDevice)
 {
     // This method must not be called when the context has already been attached!
@@ -660,6 +815,36 @@ VulkanContext* VulkanContext::getContextAttachedTo(juce::Component& c) noexcept
     return nullptr;
 }
 
+void VulkanContext::addMemoryPressureListener(MemoryPressureListener* listenerToAdd)
+{
+    memoryPressureListeners.add(listenerToAdd);
+}
+
+void VulkanContext::removeMemoryPressureListener(MemoryPressureListener* listenerToRemove)
+{
+    memoryPressureListeners.remove(listenerToRemove);
+}
+
+VulkanContext::MemoryPressure VulkanContext::getMemoryPressure() const noexcept
+{
+    return memoryPressure;
+}
+
+juce::var VulkanContext::getMemoryStatistics() const
+{
+    if (auto cd = device.get())
+    {
+        auto statistics = CachedMemory::get(*cd)->getStatistics().toVar();
+
+        if (auto object = statistics.getDynamicObject())
+            object->setProperty("commandRecycler", cd->getCommandRecycler().getStatistics().toVar());
+
+        return statistics;
+    }
+
+    return {};
+}
+
 void VulkanContext::triggerRepaint()
 {
     if (auto* cachedImage = getCachedImage())
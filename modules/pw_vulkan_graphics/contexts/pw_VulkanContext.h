@@ -35,6 +35,57 @@ namespace parawave
 class VulkanContext
 {
 public:
+    /** The memory pressure is derived from the budget of the device local heap. 
+        With VK_EXT_memory_budget this includes the memory of other contexts and processes. */
+    enum class MemoryPressure
+    {
+        normal,
+        moderate,   // Unused textures and empty memory blocks are released
+        critical    // Every texture that isn't referenced by a render pass is released
+    };
+
+    //==============================================================================
+    class MemoryPressureListener
+    {
+    public:
+        virtual ~MemoryPressureListener() = default;
+
+        /** Gets called on the render thread after a frame, if the pressure level has changed. */
+        virtual void memoryPressureChanged(VulkanContext& context, MemoryPressure newPressure) = 0;
+    };
+
+    void addMemoryPressureListener(MemoryPressureListener* listenerToAdd);
+    void removeMemoryPressureListener(MemoryPressureListener* listenerToRemove);
+
+    MemoryPressure getMemoryPressure() const noexcept;
+
+    /** Get the statistics of all memory pools and heaps of the device as JSON compatible var, 
+        e.g. to monitor the memory usage with juce::JSON::toString(). Returns a void var if 
+        no device is set. The "commandRecycler" property counts the created command buffers 
+        and semaphores, which stop growing once the transfers are recycled. */
+    juce::var getMemoryStatistics() const;
+
+    //==============================================================================
+    /** Records application commands into the framebuffer of every frame, on several threads. */
+    class ParallelRenderer
+    {
+    public:
+        virtual ~ParallelRenderer() = default;
+
+        /** Gets called on the render thread, after the components of the frame were painted. Record 
+            independent parts with recorder.record(renderPass, &framebuffer, functions), each function 
+            runs on one of the recorder threads. The commands are executed after the painted content. */
+        virtual void renderFrame(VulkanParallelRecorder& recorder, const VulkanRenderPass& renderPass, 
+            const VulkanFramebuffer& framebuffer, juce::Rectangle<int> bounds) = 0;
+    };
+
+    /** The recorder threads are only created if a renderer is set. The renderer must outlive the 
+        attachment of the context. */
+    void setParallelRenderer(ParallelRenderer* newRenderer);
+
+    ParallelRenderer* getParallelRenderer() const noexcept;
+
+    //==============================================================================
     VulkanContext();
     ~VulkanContext();
 
@@ -55,6 +106,13 @@ public:
 
     void setPresentMode(vk::PresentModeKHR preferredPresentMode);
 
+    /** Set how many frames can be rendered by the device, while the next one is already painted. 
+        More frames overlap the painting with the rendering, but add latency and memory for the 
+        additional framebuffers. The number is limited to 1 - 3, the default is 2. */
+    void setNumFramesInFlight(int numFrames);
+
+    int getNumFramesInFlight() const noexcept;
+
     void setPhysicalDevice(const VulkanPhysicalDevice& physicalDevice);
 
     void setDefaultPhysicalDevice(const VulkanInstance& instance);
@@ -87,6 +145,12 @@ private:
     vk::Format format = vk::Format::eB8G8R8A8Unorm;
     vk::ColorSpaceKHR colorSpace = vk::ColorSpaceKHR::eSrgbNonlinear;
     vk::PresentModeKHR presentMode = vk::PresentModeKHR::eMailbox;
+    int numFramesInFlight = 2;
+
+    ParallelRenderer* parallelRenderer = nullptr;
+
+    juce::ListenerList<MemoryPressureListener> memoryPressureListeners;
+    MemoryPressure memoryPressure = MemoryPressure::normal;
 
     CachedImage* getCachedImage() const noexcept;
 
@@ -91,6 +91,8 @@ struct SavedState : public juce::RenderingHelpers::SavedStateBase<SavedState>
                 return;
             }
 
+            sourceLayer->releaseChildLayers();
+
             const auto alpha = static_cast<int>(finishedLayerState.transparencyLayerAlpha * 255.0f);
 
             const auto clipBounds = clip->getClipBounds();
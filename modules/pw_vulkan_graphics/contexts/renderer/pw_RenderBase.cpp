@@ -27,12 +27,13 @@ namespace parawave
 {
     
 //==============================================================================
-/** Holds wait/signal semaphores, completed fence and command buffer. */
+/** Holds wait/signal semaphores, completed fence and command buffer. The command buffer is 
+    allocated from the transient pool of the frame, which is reset once the frame completed. */
 class RenderBase : public VulkanRenderer
 {
 public:
-    RenderBase(const DeviceState& deviceState) : 
-        state(deviceState), commandBuffer(state.device), completedSemaphore(state.device)
+    RenderBase(const DeviceState& deviceState, const VulkanCommandPool& commandPool) : 
+        state(deviceState), commandBuffer(state.device, commandPool), completedSemaphore(state.device)
     { 
         setSignalSemaphore(&completedSemaphore);
     }
@@ -51,8 +52,21 @@ public:
 
     void setSignalSemaphore(const VulkanSemaphore* newSemaphore) noexcept { currentSignalSemaphore = newSemaphore; }
 
+    VulkanSubmitBatch* getSubmitBatch() const noexcept { return submitBatch; }
+
+    /** With a batch, submit() only adds the command buffer to it. The batch is submitted at the end of the frame. */
+    void setSubmitBatch(VulkanSubmitBatch* newSubmitBatch) noexcept { submitBatch = newSubmitBatch; }
+
     vk::Result submit() const noexcept
     {
+        state.images.submitPendingTransfers(submitBatch);
+
+        if (submitBatch != nullptr)
+        {
+            submitBatch->add(commandBuffer, currentWaitSemaphore, currentSignalSemaphore);
+            return vk::Result::eSuccess;
+        }
+
         auto submitInfo = VulkanCommandSequence::SingleWaitSignalSubmit(commandBuffer);
 
         if (currentWaitSemaphore != nullptr)
@@ -64,8 +78,11 @@ public:
         return state.device.getGraphicsQueue().submit(submitInfo);
     }
 
+    /** Submits immediately and signals the fence, even if a batch is set. */
     vk::Result submit(const VulkanFence& fence) const noexcept
     {
+        state.images.submitPendingTransfers(nullptr);
+
         auto submitInfo = VulkanCommandSequence::SingleWaitSignalSubmit(commandBuffer);
 
         if (currentWaitSemaphore != nullptr)
@@ -136,6 +153,8 @@ private:
     const VulkanSemaphore* currentWaitSemaphore = nullptr;
     const VulkanSemaphore* currentSignalSemaphore = nullptr;
 
+    VulkanSubmitBatch* submitBatch = nullptr;
+
     juce::ListenerList<Listener> listenerList;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderBase)
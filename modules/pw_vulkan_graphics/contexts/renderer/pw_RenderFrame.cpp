@@ -34,16 +34,27 @@ public:
     {
         Attachment(VulkanMemoryPool& pool, const VulkanMemoryImage::CreateInfo& createInfo) : 
             memoryImage(pool, createInfo), imageView(pool.getDevice(), memoryImage.getImage()){ }
+
+        Attachment(VulkanMemoryPool& pool, const VulkanMemoryImage::CreateInfo& createInfo, VulkanMemoryImage::Aliasing& aliasing) : 
+            memoryImage(pool, createInfo, aliasing), imageView(pool.getDevice(), memoryImage.getImage()){ }
     
         const VulkanMemoryImage memoryImage;
         const VulkanImageView imageView;
     };
 
 public:
-    RenderFrame(const DeviceState& deviceState, uint32_t width, uint32_t height, vk::Format format) : 
-        RenderBase(deviceState),
-        attachment(state.memory.framebufferPool, VulkanMemoryImage::CreateInfo(width, height, format)
-            .setDeviceLocal().setColorAttachment().setSampled().setTransferDst().setTransferSrc()),
+    RenderFrame(const DeviceState& deviceState, const VulkanCommandPool& commandPool, uint32_t width, uint32_t height, vk::Format format) : 
+        RenderBase(deviceState, commandPool),
+        attachment(state.memory.framebufferPool, getAttachmentCreateInfo(width, height, format)),
+        framebuffer(state.device, state.renderPasses.offscreen, attachment.imageView, width, height)
+    {
+        bounds.setSize(static_cast<int>(width), static_cast<int>(height));
+    }
+
+    /** The attachment is bound to memory that might be shared with other frames, see VulkanMemoryImage::Aliasing. */
+    RenderFrame(const DeviceState& deviceState, const VulkanCommandPool& commandPool, VulkanMemoryImage::Aliasing& aliasing, uint32_t width, uint32_t height, vk::Format format) : 
+        RenderBase(deviceState, commandPool),
+        attachment(state.memory.framebufferPool, getAttachmentCreateInfo(width, height, format), aliasing),
         framebuffer(state.device, state.renderPasses.offscreen, attachment.imageView, width, height)
     {
         bounds.setSize(static_cast<int>(width), static_cast<int>(height));
@@ -56,6 +67,8 @@ public:
 
     const Attachment& getAttachment() const noexcept { return attachment; }
 
+    const VulkanFramebuffer& getFramebuffer() const noexcept { return framebuffer; }
+
     juce::Rectangle<int> getBounds() const noexcept { return bounds; }
 
     juce::AffineTransform getTransform() const noexcept { return transformSource ? transformSource->getTransform() : juce::AffineTransform(); }
@@ -85,15 +98,12 @@ public:
     {
         // jassert(cache);
 
-        commandBuffer.reset();
+        // The command pool of the frame was reset, so the command memory of the last recording is reused
         commandBuffer.begin();
 
         // Begin Pass : Limit render area so it's definitely inside of the framebuffer extent
         {
-            auto renderArea = attachment.memoryImage.getImage().getBounds();
-
-            renderArea.extent.width = std::min(renderArea.extent.width, static_cast<uint32_t>(bounds.getWidth()));
-            renderArea.extent.height = std::min(renderArea.extent.height, static_cast<uint32_t>(bounds.getHeight()));
+            const auto renderArea = getRenderArea();
 
             commandBuffer.beginRenderPass(state.renderPasses.offscreen, framebuffer, renderArea);
             
@@ -114,14 +124,40 @@ public:
         initialiseBindings();
     }
 
-    void endRender()
+    /** If a recorder is passed, its secondary command buffers are executed after the painted content. 
+        They must be recorded with the offscreen continue pass and the framebuffer of the frame. */
+    void endRender(const VulkanParallelRecorder* recorder = nullptr)
     {
         resetBindings();
 
         commandBuffer.endRenderPass();
+
+        if (recorder != nullptr && recorder->getNumRecorded() > 0)
+        {
+            commandBuffer.beginRenderPass(state.renderPasses.offscreenContinue, framebuffer, getRenderArea(), vk::SubpassContents::eSecondaryCommandBuffers);
+            recorder->execute(commandBuffer);
+            commandBuffer.endRenderPass();
+        }
+
         commandBuffer.end(); 
     }
 
+    static VulkanMemoryImage::CreateInfo getAttachmentCreateInfo(uint32_t width, uint32_t height, vk::Format format) noexcept
+    {
+        return VulkanMemoryImage::CreateInfo(width, height, format)
+            .setDeviceLocal().setColorAttachment().setSampled().setTransferDst().setTransferSrc().setPinned();
+    }
+
+    vk::Rect2D getRenderArea() const noexcept
+    {
+        auto renderArea = attachment.memoryImage.getImage().getBounds();
+
+        renderArea.extent.width = std::min(renderArea.extent.width, static_cast<uint32_t>(bounds.getWidth()));
+        renderArea.extent.height = std::min(renderArea.extent.height, static_cast<uint32_t>(bounds.getHeight()));
+
+        return renderArea;
+    }
+
     virtual void initialiseBindings() = 0;
 
     virtual void resetBindings() = 0;
@@ -108,7 +108,7 @@ struct QuadQueue
 
     void bindIndexBuffer() noexcept
     {
-        commandBuffer.bindIndexBuffer(deviceState.memory.defaultQuadIndices.getBuffer());
+        commandBuffer.bindIndexBuffer(deviceState.memory.defaultQuadIndices);
     }
 
     template <typename IteratorType>
@@ -149,18 +149,19 @@ struct QuadQueue
             draw();
     }
 
+    void setVertexRing(VulkanMemoryRing* newVertexRing) noexcept
+    {
+        vertexRing = newVertexRing;
+    }
+
     void draw() noexcept
     {
         jassert(commandBuffer.getHandle());
+        jassert(vertexRing != nullptr);
 
-        const auto createInfo = VulkanMemoryBuffer::CreateInfo()
-            .setSize<VertexType>(numVertices).setHostVisible().setVertexBuffer();
-
-        auto vertexBuffer = vertexBuffers.add(new VulkanMemoryBuffer(deviceState.memory.vertexPool, createInfo));
-        vertexBuffer->write(vertexData, static_cast<vk::DeviceSize>(numVertices * sizeof(VertexType)));
-        vertexBuffer->setDefragmentOnRelease(false);
+        const auto vertices = vertexRing->write(vertexData, static_cast<vk::DeviceSize>(numVertices * sizeof(VertexType)), sizeof(VertexType));
         
-        commandBuffer.bindVertexBuffer(vertexBuffer->getBuffer());
+        commandBuffer.bindVertexBuffer(*vertices.buffer, vertices.offset);
        
         const auto numIndices = static_cast<uint32_t>((numVertices * 3) / 2);
         commandBuffer.drawIndexed(numIndices);
@@ -170,13 +171,7 @@ struct QuadQueue
 
     void reset()
     {
-        // Before we release all framebuffes we turn on defragmentation
-        // With this we avoid a constantly growing memory allocations for vertex buffers
-
-        for (auto& vertexBuffer : vertexBuffers)
-            vertexBuffer->setDefragmentOnRelease(true);
-
-        vertexBuffers.clearQuick(true);
+        numVertices = 0;
     }
 
 private:
@@ -184,7 +179,7 @@ private:
     const VulkanCommandBuffer& commandBuffer;
     
     VertexType vertexData[maxNumQuads * 4];
-    juce::OwnedArray<VulkanMemoryBuffer> vertexBuffers;
+    VulkanMemoryRing* vertexRing = nullptr;
 
     int numVertices = 0;
     int maxVertices = 0;
@@ -193,16 +188,153 @@ private:
 };
 
 //==============================================================================
+/** 
+    FrameArena
+
+    A monotonic allocator for the transient objects of one frame. Objects are 
+    placed into large blocks by moving an offset forward, and all of them are 
+    destroyed at once by reset(), in reverse order of their creation. 
+
+    The blocks are kept for the next frame. If a frame needed more than one 
+    block, they are merged into one block of the combined size, so in a steady 
+    frame the arena itself doesn't call malloc or free.
+*/
+class FrameArena final
+{
+public:
+    enum { defaultBlockSize = 16 * 1024 };
+
+    FrameArena() = default;
+
+    ~FrameArena()
+    {
+        destroyObjects();
+    }
+
+    template <typename ObjectType, typename... Args>
+    ObjectType* create(Args&&... args)
+    {
+        auto object = new (allocate(sizeof(ObjectType), alignof(ObjectType))) ObjectType(std::forward<Args>(args)...);
+
+        if (! std::is_trivially_destructible<ObjectType>::value)
+            destructors.add({ object, [](void* o) { static_cast<ObjectType*>(o)->~ObjectType(); } });
+
+        return object;
+    }
+
+    void* allocate(size_t size, size_t alignment)
+    {
+        jassert(juce::isPowerOfTwo(alignment));
+
+        for (; currentBlock < blocks.size(); ++currentBlock, currentOffset = 0)
+        {
+            auto& block = *blocks.getUnchecked(currentBlock);
+
+            const auto address = reinterpret_cast<uintptr_t>(block.data.get()) + currentOffset;
+            const auto padding = static_cast<size_t>((alignment - (address & (alignment - 1))) & (alignment - 1));
+
+            if (currentOffset + padding + size <= block.size)
+            {
+                auto data = block.data.get() + currentOffset + padding;
+                currentOffset += padding + size;
+
+                return data;
+            }
+        }
+
+        const auto blockSize = std::max(size + alignment, blocks.isEmpty() ? static_cast<size_t>(defaultBlockSize) : blocks.getLast()->size * 2);
+        addBlock(blockSize);
+
+        return allocate(size, alignment);
+    }
+
+    /** Destroy all objects of the frame and rewind. */
+    void reset()
+    {
+        destroyObjects();
+
+        if (blocks.size() > 1)
+        {
+            size_t totalSize = 0;
+
+            for (auto block : blocks)
+                totalSize += block->size;
+
+            blocks.clear(true);
+            addBlock(totalSize);
+        }
+
+        currentBlock = 0;
+        currentOffset = 0;
+    }
+
+private:
+    struct Block
+    {
+        juce::HeapBlock<char> data;
+        size_t size = 0;
+    };
+
+    struct Destructor
+    {
+        void* object;
+        void (*destroy)(void*);
+    };
+
+    void addBlock(size_t blockSize)
+    {
+        auto block = blocks.add(new Block());
+
+        block->data.malloc(blockSize);
+        block->size = blockSize;
+    }
+
+    void destroyObjects()
+    {
+        for (int i = destructors.size(); --i >= 0;)
+        {
+            const auto& destructor = destructors.getReference(i);
+            destructor.destroy(destructor.object);
+        }
+
+        destructors.clearQuick();
+    }
+
+    juce::OwnedArray<Block> blocks;
+    juce::Array<Destructor> destructors;
+
+    int currentBlock = 0;
+    size_t currentOffset = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FrameArena)
+};
+
+//==============================================================================
+/** 
+    GradientCache
+
+    The lookup textures of the gradients of one frame. The textures live across 
+    frames, with their views, descriptors and staging buffers. A gradient with the 
+    same colours as a texture of the previous frames reuses it without an upload, 
+    any other gradient rewrites the content of a texture that isn't used in this 
+    frame yet. Only if there is none, a new texture is created. Textures that 
+    weren't used for a number of frames are released.
+*/
 struct GradientCache
 {
     GradientCache(const DeviceState& deviceState_) noexcept : 
         deviceState(deviceState_), sampler(deviceState.device, VulkanSampler::CreateInfo().setFilter(vk::Filter::eLinear)) { }
 
+    /** Called once the frame has completed, so none of the textures is read by the device. */
     void reset()
     {
-        descriptors.clearQuick(true);
-        textures.clearQuick(true);
+        ++frameCounter;
+
+        for (int i = textures.size(); --i >= 0;)
+            if (frameCounter - textures.getUnchecked(i)->lastUsedFrame > maxUnusedFrames)
+                textures.remove(i);
 
+        currentTexture = nullptr;
         gradientNeedsRefresh = true;
     }
 
@@ -213,23 +345,15 @@ struct GradientCache
 
     SingleImageSamplerDescriptor* getTextureForGradient(const juce::ColourGradient& gradient)
     {
-        if (gradientNeedsRefresh)
+        if (gradientNeedsRefresh || currentTexture == nullptr)
         {
             gradientNeedsRefresh = false;
 
-            auto texture = textures.add(new LookupTexture(deviceState));
-            texture->setGradient(gradient);
-
-            auto descriptor = descriptors.add(new SingleImageSamplerDescriptor(deviceState.images.getImageSamplerDescriptorPool()));
-            descriptor->update(*texture->view, sampler);
-
-            /** TODO: Reuse descriptor set and maybe texures, just upload new gradient data into existing textures,
-                since the size is always the same. */
-
-            return descriptor;
+            currentTexture = findTexture(gradient);
+            currentTexture->lastUsedFrame = frameCounter;
         }
 
-        return descriptors.getLast();
+        return &currentTexture->descriptor;
     }
 
 private:
@@ -243,56 +367,91 @@ private:
         static constexpr auto defaultFormat = vk::Format::eB8G8R8A8Unorm;
         static constexpr auto lookupSize = static_cast<vk::DeviceSize>(numPixels * 4);
         
-        LookupTexture(const DeviceState& deviceState)
+        LookupTexture(const DeviceState& deviceState, const VulkanSampler& sampler) :
+            texture(deviceState.memory.smallTexturePool, VulkanMemoryImage::CreateInfo(numPixels, 1, defaultFormat)
+                .setDeviceLocal().setSampled().setTransferDst().setPinned()),
+            view(deviceState.device, texture.getImage()),
+            stagingBuffer(deviceState.memory.stagingPool, VulkanMemoryBuffer::CreateInfo()
+                .setHostUpload().setTransferSrc().setSize(lookupSize).setPinned()),
+            transfer(deviceState.device, texture.getImage(), stagingBuffer),
+            descriptor(deviceState.images.getImageSamplerDescriptorPool())
         {
-            const auto& device = deviceState.device;
-            auto& pool = deviceState.memory.smallTexturePool;
+            // The uploads are submitted with the passes of the frame
+            transfer.setSubmitBatch(deviceState.images.getSubmitBatch());
 
-            const auto imageCreateInfo = VulkanMemoryImage::CreateInfo(numPixels, 1, defaultFormat)
-                .setDeviceLocal().setSampled().setTransferDst();
+            descriptor.update(view, sampler);
+        }
 
-            texture.reset(new VulkanMemoryImage(pool, imageCreateInfo));
-            view.reset(new VulkanImageView(device, texture->getImage()));
+        /** The lookup table only depends on the colours, not on the points of the gradient. */
+        bool hasColoursOf(const juce::ColourGradient& other) const noexcept
+        {
+            if (gradient.getNumColours() != other.getNumColours())
+                return false;
 
-            const auto bufferCreateInfo = VulkanMemoryBuffer::CreateInfo()
-                .setHostVisible().setTransferSrc().setSize(lookupSize);
+            for (int i = 0; i < gradient.getNumColours(); ++i)
+                if (gradient.getColour(i) != other.getColour(i) || gradient.getColourPosition(i) != other.getColourPosition(i))
+                    return false;
 
-            stagingBuffer.reset(new VulkanMemoryBuffer(pool, bufferCreateInfo));
-            transfer.reset(new VulkanImageTransfer(device, texture->getImage(), *stagingBuffer));
+            return true;
         }
 
-        ~LookupTexture()
+        /** The previous upload has completed, since the texture isn't used in this frame yet. */
+        void setGradient(const juce::ColourGradient& newGradient)
         {
-            texture->setDefragmentOnRelease(false);
-            stagingBuffer->setDefragmentOnRelease(false);
-        }
+            gradient = newGradient;
 
-        void setGradient(const juce::ColourGradient& gradient) const
-        {
             juce::PixelARGB lookup[numPixels];
             gradient.createLookupTable(lookup, numPixels);
 
-            transfer->writePixels(lookup, lookupSize);
-            transfer->copyBufferToImage();
+            transfer.writePixels(lookup, lookupSize);
+            transfer.copyBufferToImage();
         }
 
-        std::unique_ptr<VulkanMemoryImage> texture;
-        std::unique_ptr<VulkanImageView> view;
+        const VulkanMemoryImage texture;
+        const VulkanImageView view;
+
+        const VulkanMemoryBuffer stagingBuffer;
+        VulkanImageTransfer transfer;
+
+        SingleImageSamplerDescriptor descriptor;
 
-        // TODO: reset stagingBuffer & transfer after initial upload !
-        std::unique_ptr<VulkanMemoryBuffer> stagingBuffer;
-        std::unique_ptr<VulkanImageTransfer> transfer;
+        juce::ColourGradient gradient;
+        juce::uint32 lastUsedFrame = 0;
     };
 
+    /** A texture with the colours of the gradient, otherwise one that isn't used in this frame 
+        is rewritten, preferably the least recently used. */
+    LookupTexture* findTexture(const juce::ColourGradient& gradient)
+    {
+        LookupTexture* unusedTexture = nullptr;
+
+        for (auto texture : textures)
+        {
+            if (texture->hasColoursOf(gradient))
+                return texture;
+
+            if (texture->lastUsedFrame != frameCounter && (unusedTexture == nullptr || texture->lastUsedFrame < unusedTexture->lastUsedFrame))
+                unusedTexture = texture;
+        }
+
+        if (unusedTexture == nullptr)
+            unusedTexture = textures.add(new LookupTexture(deviceState, sampler));
+
+        unusedTexture->setGradient(gradient);
+        return unusedTexture;
+    }
+
 private:
-    enum { numTexturesToCache = 8, numGradientTexturesToCache = 10 };
+    enum { maxUnusedFrames = 120 };
 
     const DeviceState& deviceState;
 
     const VulkanSampler sampler;
 
     juce::OwnedArray<LookupTexture> textures;
-    juce::OwnedArray<SingleImageSamplerDescriptor> descriptors;
+    LookupTexture* currentTexture = nullptr;
+
+    juce::uint32 frameCounter = 1;
 
     bool gradientNeedsRefresh = true;
 
@@ -27,39 +27,214 @@ namespace parawave
 {
    
 //==============================================================================
-struct RenderCache
+/** 
+    Device memory for the attachments of the transparency layers of a frame. 
+
+    All layers of a frame are chained by semaphores, each one waits for the 
+    previously created layer. A layer is only sampled by the layer that created 
+    it, so once that one is submitted, the layers created afterwards can alias 
+    the memory of its attachment.
+
+    The ranges outlive the frame, together with the pooled layers bound to them. 
+    A pooled layer can only be reused, if no other layer uses its range.
+*/
+class LayerMemory final : public VulkanMemoryImage::Aliasing
 {
-    RenderCache(DeviceState& deviceState_) :
-        deviceState(deviceState_),
-        gradientCache(deviceState)
-    { }
+public:
+    explicit LayerMemory(VulkanMemoryPool& pool_) noexcept : pool(pool_) {}
+
+    ~LayerMemory() override
+    {
+        for (auto slot : slots)
+            disposeRange(slot->range);
+    }
+
+    /** Use the smallest released range that fits, or acquire a new one. */
+    VulkanMemoryRange getRangeFor(const VulkanImage& image) override
+    {
+        const auto memoryRequirements = image.getMemoryRequirements();
+        const auto memoryTypeIndex = pool.getMemoryTypeIndex(memoryRequirements, memoryProperties);
+
+        Slot* bestSlot = nullptr;
+
+        for (auto slot : slots)
+        {
+            const auto& range = slot->range;
+
+            if (slot->inUse || range.getSize() < memoryRequirements.size || range.getOffset() % memoryRequirements.alignment != 0
+                || range.getMemoryBlock()->getMemoryTypeIndex() != memoryTypeIndex)
+                continue;
+
+            if (bestSlot == nullptr || range.getSize() < bestSlot->range.getSize())
+                bestSlot = slot;
+        }
+
+        if (bestSlot == nullptr)
+        {
+            bestSlot = slots.add(new Slot());
+            bestSlot->range = pool.acquire(memoryRequirements, memoryProperties);
+
+            // The layers bound to the range are pooled, so it can't be moved
+            pool.pin(bestSlot->range);
+        }
+
+        ++bestSlot->numImages;
+        bestSlot->inUse = true;
+
+        return bestSlot->range;
+    }
+
+    /** Use the range for a pooled layer again. Returns false if another layer uses it. */
+    bool tryAcquire(const VulkanMemoryRange& range) noexcept
+    {
+        if (auto slot = findSlot(range))
+        {
+            if (slot->inUse)
+                return false;
+
+            slot->inUse = true;
+            return true;
+        }
+
+        jassertfalse;
+        return false;
+    }
+
+    /** The attachment bound to the range won't be used anymore by the commands recorded after this call. */
+    void release(const VulkanMemoryRange& range) noexcept
+    {
+        if (auto slot = findSlot(range))
+            slot->inUse = false;
+    }
 
-    void reset()
+    /** Called once the frame has completed. */
+    void releaseAll() noexcept
     {
-        gradientCache.reset();
+        for (auto slot : slots)
+            slot->inUse = false;
+    }
 
-        layers.clearQuick(true);
+    /** Called before an image bound to the range is destroyed. The range returns to the 
+        pool, once no image is bound to it anymore. */
+    void removeImage(const VulkanMemoryRange& range)
+    {
+        for (int i = slots.size(); --i >= 0;)
+        {
+            auto slot = slots.getUnchecked(i);
 
-        textures.clearQuick();
-        imageSamplerDescriptors.clearQuick(true);
+            if (slot->range == range && --slot->numImages <= 0)
+            {
+                disposeRange(slot->range);
+                slots.remove(i);
+            }
+        }
+    }
 
-        framebufferPixelData.clearQuick();
+private:
+    struct Slot
+    {
+        VulkanMemoryRange range;
+        int numImages = 0;
+        bool inUse = false;
+    };
+
+    void disposeRange(const VulkanMemoryRange& range)
+    {
+        pool.unpin(range);
+        pool.dispose(range);
+    }
+
+    Slot* findSlot(const VulkanMemoryRange& range) const noexcept
+    {
+        for (auto slot : slots)
+            if (slot->range == range)
+                return slot;
+
+        return nullptr;
     }
 
+    VulkanMemoryPool& pool;
+    const vk::MemoryPropertyFlags memoryProperties { vk::MemoryPropertyFlagBits::eDeviceLocal };
+
+    juce::OwnedArray<Slot> slots;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LayerMemory)
+};
+
+//==============================================================================
+struct RenderCache
+{
+    /** Initial size of the vertex ring, enough for a few full quad batches. Grows on demand. */
+    static constexpr vk::DeviceSize vertexRingSize = 8 * QuadQueue::maxNumQuads * 4 * sizeof(QuadQueue::VertexType);
+
+    RenderCache(DeviceState& deviceState_, const VulkanCommandPool& commandPool_) :
+        deviceState(deviceState_), commandPool(commandPool_),
+        gradientCache(deviceState),
+        vertexRing(deviceState.memory.vertexPool, vertexRingSize, vk::BufferUsageFlagBits::eVertexBuffer),
+        layerMemory(deviceState.memory.framebufferPool)
+    { }
+
+    /** Called once the frame has completed. */
+    void reset();
+
+    /** Reuse a layer of a previous frame with the same size bucket and format, or create a new one. */
+    RenderLayer* checkoutLayer(uint32_t width, uint32_t height, vk::Format format);
+
+    /** Release the pooled layers that weren't used for a number of frames or for a while, and the 
+        least recently used ones above the limit. The time limit also applies if no frame is drawn. */
+    void trimFreeLayers();
+
+    /** Release all pooled layers, e.g. under memory pressure. They aren't used by the device, 
+        only the layers checked out by a frame in flight are. */
+    void releaseFreeLayers();
+
     SingleImageSamplerDescriptor* createImageSamplerDescriptor()
     {
-        return imageSamplerDescriptors.add(new SingleImageSamplerDescriptor(deviceState.images.getImageSamplerDescriptorPool()));
+        return arena.create<SingleImageSamplerDescriptor>(deviceState.images.getImageSamplerDescriptorPool());
     }
         
     DeviceState& deviceState;
+
+    // The transient pool of the frame, the command buffers of the layers are allocated from it
+    const VulkanCommandPool& commandPool;
+
+    // Transient objects of the frame. Declared before anything that refers to them.
+    FrameArena arena;
+
     GradientCache gradientCache;
 
+    // Vertices of all layers in this frame, recycled once the frame completed
+    VulkanMemoryRing vertexRing;
+
+    // Declared before the layers, since their attachments are bound to its ranges
+    LayerMemory layerMemory;
+
+    // The layers checked out in the current frame and the pooled layers of previous frames
     juce::OwnedArray<RenderLayer> layers;
+    juce::OwnedArray<RenderLayer> freeLayers;
+
+    juce::uint32 frameCounter = 0;
 
     juce::ReferenceCountedArray<VulkanTexture> textures;
-    juce::OwnedArray<SingleImageSamplerDescriptor> imageSamplerDescriptors;
 
     juce::ReferenceCountedArray<juce::ReferenceCountedObject> framebufferPixelData;
+
+private:
+    enum
+    {
+        layerSizeBucket = 64,
+        maxNumFreeLayers = 32,
+        maxUnusedFrames = 120
+    };
+
+    static constexpr juce::uint32 maxUnusedTime = 2000; // ms
+
+    static uint32_t getBucketSize(uint32_t size) noexcept
+    {
+        return ((size + layerSizeBucket - 1) / layerSizeBucket) * layerSizeBucket;
+    }
+
+    void deleteFreeLayer(int index);
 };
 
 //==============================================================================
@@ -90,8 +265,12 @@ private:
     };
 
 public:
-    RenderLayer(const DeviceState& deviceState, uint32_t width, uint32_t height, vk::Format format) :
-        RenderFrame(deviceState, width, height, format), quadQueue(deviceState, commandBuffer)
+    RenderLayer(const DeviceState& deviceState, const VulkanCommandPool& commandPool, uint32_t width, uint32_t height, vk::Format format) :
+        RenderFrame(deviceState, commandPool, width, height, format), quadQueue(deviceState, commandBuffer)
+    {}
+
+    RenderLayer(const DeviceState& deviceState, const VulkanCommandPool& commandPool, LayerMemory& layerMemory, uint32_t width, uint32_t height, vk::Format format) :
+        RenderFrame(deviceState, commandPool, layerMemory, width, height, format), quadQueue(deviceState, commandBuffer)
     {}
 
     ~RenderLayer() override = default;
@@ -104,6 +283,10 @@ public:
     void resetBindings() override
     {
         quadQueue.flush();
+
+        // All vertices of the layer are written, make them visible before the submit
+        if (cache != nullptr)
+            cache->vertexRing.flush();
     }
 
     void setSamplerQuality(juce::Graphics::ResamplingQuality newQuality)
@@ -334,22 +517,53 @@ public:
         const auto framebufferFormat = getAttachment().memoryImage.getImage().getFormat();
         jassert(framebufferFormat != vk::Format::eUndefined);
 
-        auto layer = cache->layers.add(new RenderLayer(state, width, height, framebufferFormat));
+        auto layer = cache->checkoutLayer(width, height, framebufferFormat);
+        childLayers.add(layer);
 
-        // Since the new layer will render to a buffer at position zero, the bound must be offset by the current clip area
-        const auto newBounds = layer->getBounds().withPosition(frameArea.getPosition());
-        layer->setBounds(newBounds);
+        // The layer renders to a buffer at position zero and might be bigger, so the bounds are set to the clip area
+        layer->setBounds(frameArea);
 
         // The current layer must wait for all commands of the new layer
         layer->setWaitSemaphore(getWaitSemaphore());
         setWaitSemaphore(&layer->getCompletedSemaphore());
 
-        // The new layer will use the same frame cache for intermediate allocations
+        // The new layer will use the same frame cache for intermediate allocations ..
         layer->setCache(cache);
 
+        // .. and is submitted in the same batch, before this layer
+        layer->setSubmitBatch(getSubmitBatch());
+
         return layer;
     }
 
+    /** Call after the layer was submitted. Its child layers were only sampled by this layer, 
+        so the layers created afterwards can alias the memory of their attachments. */
+    void releaseChildLayers() noexcept
+    {
+        for (auto childLayer : childLayers)
+            cache->layerMemory.release(childLayer->getAttachment().memoryImage.getMemoryRange());
+
+        childLayers.clearQuick();
+    }
+
+    juce::uint32 getLastUsedFrame() const noexcept { return lastUsedFrame; }
+
+    /** The millisecond counter at the last checkout. */
+    juce::uint32 getLastUsedTime() const noexcept { return lastUsedTime; }
+
+    /** Prepare a pooled layer for the frame. */
+    void checkout(juce::uint32 frameNumber) noexcept
+    {
+        lastUsedFrame = frameNumber;
+        lastUsedTime = juce::Time::getMillisecondCounter();
+
+        childLayers.clearQuick();
+        quadQueue.reset();
+
+        setWaitSemaphore(nullptr);
+        setSignalSemaphore(&getCompletedSemaphore());
+    }
+
     template <typename IteratorType>
     void renderLayerTransformed(IteratorType& iter, const RenderLayer& src, int alpha, const juce::AffineTransform& transform)
     {
@@ -358,10 +572,13 @@ public:
         // Create texture info, so the layer framebuffer is handled like a regular texture image
         ImageInfo info;
 
+        // A pooled layer might be bigger than its bounds
+        const auto& extent = src.getAttachment().memoryImage.getImage().getExtent();
+
         info.width = static_cast<uint32_t>(layerBounds.getWidth());
         info.height = static_cast<uint32_t>(layerBounds.getHeight());
-        info.widthProportion = 1.0f;
-        info.heightProportion = 1.0f;
+        info.widthProportion = static_cast<float>(info.width) / static_cast<float>(extent.width);
+        info.heightProportion = static_cast<float>(info.height) / static_cast<float>(extent.height);
 
         // Create a Texture Descriptor and set it to the FrameLayer framebuffer image view
         const auto descriptor = cache->createImageSamplerDescriptor();
@@ -410,6 +627,8 @@ protected:
         jassert(newCache);
         cache = newCache;
 
+        quadQueue.setVertexRing(&cache->vertexRing);
+
         currentQuality = juce::Graphics::ResamplingQuality::mediumResamplingQuality;
         currentSampler = &state.images.getSampler(currentQuality);
     }
@@ -423,7 +642,102 @@ protected:
 private:
     RenderCache* cache = nullptr;
 
+    juce::Array<RenderLayer*> childLayers;
+
+    juce::uint32 lastUsedFrame = 0;
+    juce::uint32 lastUsedTime = 0;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderLayer)
 };
 
+//==============================================================================
+inline void RenderCache::reset()
+{
+    gradientCache.reset();
+    vertexRing.reset();
+
+    ++frameCounter;
+
+    // The frame has completed, its layers return to the pool
+    while (! layers.isEmpty())
+        freeLayers.add(layers.removeAndReturn(layers.size() - 1));
+
+    layerMemory.releaseAll();
+
+    trimFreeLayers();
+
+    textures.clearQuick();
+    framebufferPixelData.clearQuick();
+
+    // Destroys the transient descriptors of the frame
+    arena.reset();
+}
+
+inline void RenderCache::trimFreeLayers()
+{
+    const auto time = juce::Time::getMillisecondCounter();
+
+    for (int i = freeLayers.size(); --i >= 0;)
+    {
+        const auto layer = freeLayers.getUnchecked(i);
+
+        if (frameCounter - layer->getLastUsedFrame() > maxUnusedFrames || time - layer->getLastUsedTime() > maxUnusedTime)
+            deleteFreeLayer(i);
+    }
+
+    while (freeLayers.size() > maxNumFreeLayers)
+    {
+        auto leastRecentlyUsed = 0;
+
+        for (int i = 1; i < freeLayers.size(); ++i)
+            if (freeLayers.getUnchecked(i)->getLastUsedFrame() < freeLayers.getUnchecked(leastRecentlyUsed)->getLastUsedFrame())
+                leastRecentlyUsed = i;
+
+        deleteFreeLayer(leastRecentlyUsed);
+    }
+}
+
+inline void RenderCache::releaseFreeLayers()
+{
+    for (int i = freeLayers.size(); --i >= 0;)
+        deleteFreeLayer(i);
+}
+
+inline RenderLayer* RenderCache::checkoutLayer(uint32_t width, uint32_t height, vk::Format format)
+{
+    const auto bucketWidth = getBucketSize(width);
+    const auto bucketHeight = getBucketSize(height);
+
+    RenderLayer* layer = nullptr;
+
+    for (int i = freeLayers.size(); --i >= 0;)
+    {
+        const auto& memoryImage = freeLayers.getUnchecked(i)->getAttachment().memoryImage;
+        const auto& image = memoryImage.getImage();
+
+        if (image.getExtent().width == bucketWidth && image.getExtent().height == bucketHeight && image.getFormat() == format
+            && layerMemory.tryAcquire(memoryImage.getMemoryRange()))
+        {
+            layer = layers.add(freeLayers.removeAndReturn(i));
+            break;
+        }
+    }
+
+    if (layer == nullptr)
+        layer = layers.add(new RenderLayer(deviceState, commandPool, layerMemory, bucketWidth, bucketHeight, format));
+
+    layer->checkout(frameCounter);
+    return layer;
+}
+
+inline void RenderCache::deleteFreeLayer(int index)
+{
+    std::unique_ptr<RenderLayer> layer(freeLayers.removeAndReturn(index));
+    const auto range = layer->getAttachment().memoryImage.getMemoryRange();
+
+    // Destroy the image before its range is returned to the pool
+    layer.reset();
+    layerMemory.removeImage(range);
+}
+
 } // namespace parawave
@@ -46,8 +46,9 @@ struct ImagePushConstants
                       .inverted().scaled (fullWidthProportion  / (float) imageWidth,
                                           fullHeightProportion / (float) imageHeight);
 
+        // Flip within the used part of the image, a framebuffer can be bigger than its content
         if(flipY)
-            t = t.followedBy(juce::AffineTransform::verticalFlip(1.0f));
+            t = t.followedBy(juce::AffineTransform::verticalFlip(fullHeightProportion));
 
         matrix.set(t);
 
@@ -33,12 +33,16 @@
 *******************************************************************************/
 #include "pw_vulkan_graphics.h"
 
-/** Define the type identifier of the VulkanImageType. Change this number in case of 
+/** Define the type identifiers of the VulkanImageType and VulkanHostImageType. Change these in case of 
     conflicts with other juce::ImageType implementations that use the same id. */
 #ifndef PW_VULKAN_IMAGE_TYPE_ID
   #define PW_VULKAN_IMAGE_TYPE_ID 4
 #endif
 
+#ifndef PW_VULKAN_HOST_IMAGE_TYPE_ID
+  #define PW_VULKAN_HOST_IMAGE_TYPE_ID 5
+#endif
+
 //==============================================================================
 
 namespace parawave
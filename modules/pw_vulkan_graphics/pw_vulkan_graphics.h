@@ -64,6 +64,7 @@ namespace parawave
 {
     class VulkanContext;
     class VulkanImageType;
+    class VulkanHostImageType;
     class VulkanAppComponent;
 } // namespace parawave
 
@@ -118,8 +118,9 @@ private:
 
             // Vulkan staged Image to Buffer transfer
             {
+                // Host cached memory, write-combined memory is very slow to read
                 const auto bufferCreateInfo = VulkanMemoryBuffer::CreateInfo()
-                .setHostVisible().setTransferDst().setSize(copySize);
+                .setHostReadback().setTransferDst().setSize(copySize);
 
                 const VulkanMemoryBuffer stagingBuffer(state.deviceState.memory.stagingPool, bufferCreateInfo);
                 VulkanImageTransfer transfer(state.deviceState.device, image, stagingBuffer);
@@ -136,25 +137,8 @@ private:
                 
                 transfer.waitForFence();
 
-                transfer.readPixels(bitmapData.data, copySize);
-            }
-
-            verticalRowFlip ((juce::PixelARGB*) bitmapData.data, bitmapData.width, bitmapData.height);
-        }
-
-        static void verticalRowFlip(juce::PixelARGB* const data, const int w, const int h)
-        {
-            juce::HeapBlock<juce::PixelARGB> tempRow (w);
-            auto rowSize = (size_t) w * sizeof (juce::PixelARGB);
-
-            for (int y = 0; y < h / 2; ++y)
-            {
-                juce::PixelARGB* const row1 = data + y * w;
-                juce::PixelARGB* const row2 = data + (h - 1 - y) * w;
-                
-                std::memcpy (tempRow, row1, rowSize);
-                std::memcpy (row1, row2, rowSize);
-                std::memcpy (row2, tempRow, rowSize);
+                const auto rowSize = static_cast<size_t>(bitmapData.width) * sizeof(juce::PixelARGB);
+                transfer.readPixelsFlipped(bitmapData.data, static_cast<size_t>(bitmapData.lineStride), rowSize, bitmapData.height);
             }
         }
     };
@@ -181,7 +165,7 @@ private:
             // Vulkan staged Buffer to Image transfer
             {
                 const auto bufferCreateInfo = VulkanMemoryBuffer::CreateInfo()
-                .setHostVisible().setTransferSrc().setSize(copySize);
+                .setHostUpload().setTransferSrc().setSize(copySize);
 
                 const VulkanMemoryBuffer stagingBuffer(state.deviceState.memory.stagingPool, bufferCreateInfo);
                 VulkanImageTransfer transfer(state.deviceState.device, image, stagingBuffer);
@@ -257,4 +241,99 @@ int VulkanImageType::getTypeID() const
     return static_cast<int>(PW_VULKAN_IMAGE_TYPE_ID);
 }
 
+//==============================================================================
+/** Software pixel data in an aligned allocation, that can be imported as device memory. */
+class VulkanHostPixelData : public juce::ImagePixelData
+{
+public:
+    VulkanHostPixelData(juce::Image::PixelFormat format, int w, int h, bool shouldClearImage, size_t alignment_) : 
+        ImagePixelData(format, w, h),
+        alignment(alignment_),
+        pixelStride(format == juce::Image::RGB ? 3 : (format == juce::Image::ARGB ? 4 : 1)),
+        lineStride((pixelStride * juce::jmax(1, w) + 3) & ~3)
+    {
+        jassert(juce::isPowerOfTwo(alignment));
+
+        // Like juce::SoftwarePixelData, one extra line for renderers that read past the end
+        const auto dataSize = static_cast<size_t>(lineStride) * static_cast<size_t>(juce::jmax(1, h) + 1);
+        allocationSize = (dataSize + alignment - 1) & ~(alignment - 1);
+
+        storage.allocate(allocationSize + alignment, shouldClearImage);
+
+        const auto address = (reinterpret_cast<uintptr_t>(storage.get()) + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+        imageData = reinterpret_cast<uint8_t*>(address);
+    }
+
+    std::unique_ptr<juce::LowLevelGraphicsContext> createLowLevelContext() override
+    {
+        sendDataChangeMessage();
+        return std::make_unique<juce::LowLevelGraphicsSoftwareRenderer>(juce::Image(this));
+    }
+
+    void initialiseBitmapData(juce::Image::BitmapData& bitmapData, int x, int y, juce::Image::BitmapData::ReadWriteMode mode) override
+    {
+        bitmapData.data = imageData + static_cast<size_t>(x * pixelStride) + static_cast<size_t>(y * lineStride);
+        bitmapData.pixelFormat = pixelFormat;
+        bitmapData.lineStride = lineStride;
+        bitmapData.pixelStride = pixelStride;
+
+        if (mode != juce::Image::BitmapData::readOnly)
+            sendDataChangeMessage();
+    }
+
+    ImagePixelData::Ptr clone() override
+    {
+        auto s = new VulkanHostPixelData(pixelFormat, width, height, false, alignment);
+        std::memcpy(s->imageData, imageData, static_cast<size_t>(lineStride) * static_cast<size_t>(height));
+        return *s;
+    }
+
+    std::unique_ptr<juce::ImageType> createType() const override { return std::make_unique<VulkanHostImageType>(alignment); }
+
+    uint8_t* getAllocationData() const noexcept { return imageData; }
+
+    size_t getAllocationSize() const noexcept { return allocationSize; }
+
+private:
+    const size_t alignment;
+    const int pixelStride, lineStride;
+
+    juce::HeapBlock<uint8_t> storage;
+    uint8_t* imageData = nullptr;
+    size_t allocationSize = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VulkanHostPixelData)
+};
+
+//==============================================================================
+VulkanHostImageType::VulkanHostImageType(size_t alignment_) : alignment(alignment_) {}
+VulkanHostImageType::~VulkanHostImageType() = default;
+
+juce::ImagePixelData::Ptr VulkanHostImageType::create(juce::Image::PixelFormat format, int width, int height, bool shouldClearImage) const
+{
+    return *new VulkanHostPixelData(format, width, height, shouldClearImage, alignment);
+}
+
+int VulkanHostImageType::getTypeID() const
+{
+    return static_cast<int>(PW_VULKAN_HOST_IMAGE_TYPE_ID);
+}
+
+bool VulkanHostImageType::getAllocation(const juce::Image& image, void*& data, size_t& size) noexcept
+{
+    if (auto pixelData = dynamic_cast<VulkanHostPixelData*>(image.getPixelData()))
+    {
+        data = pixelData->getAllocationData();
+        size = pixelData->getAllocationSize();
+        return true;
+    }
+
+    return false;
+}
+
+size_t VulkanHostImageType::getDefaultAlignment() noexcept
+{
+    return static_cast<size_t>(juce::nextPowerOfTwo(juce::jmax(4096, juce::SystemStats::getPageSize())));
+}
+
 } // namespace parawave
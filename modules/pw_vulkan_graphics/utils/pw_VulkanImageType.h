@@ -45,4 +45,34 @@ public:
     const VulkanContext& context;
 };
 
+//==============================================================================
+/** A software image type, which stores the pixels in page aligned memory. 
+
+    When the device supports VK_EXT_external_memory_host, the renderer imports the 
+    pixel memory once and copies the ARGB pixels straight into the texture, without 
+    converting them into a staging buffer first. Use it for big images that are drawn 
+    in software and change often, like spectrograms or waveform overviews. Without 
+    the extension these images are uploaded like any other software image.
+*/
+class VulkanHostImageType : public juce::ImageType
+{
+public:
+    /** The alignment must be a power of two and a multiple of the minimum imported host 
+        pointer alignment of the device, which is the page size on most drivers. */
+    explicit VulkanHostImageType(size_t alignment = getDefaultAlignment());
+    ~VulkanHostImageType() override;
+
+    juce::ImagePixelData::Ptr create(juce::Image::PixelFormat, int width, int height, bool shouldClearImage) const override;
+    
+    int getTypeID() const override;
+
+    /** Get the aligned allocation that holds the pixels of an image of this type. Returns 
+        false if the image was created by a different image type. */
+    static bool getAllocation(const juce::Image& image, void*& data, size_t& size) noexcept;
+
+    static size_t getDefaultAlignment() noexcept;
+
+    const size_t alignment;
+};
+
 } // namespace parawave
\ No newline at end of file
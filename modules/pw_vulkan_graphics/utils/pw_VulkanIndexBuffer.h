@@ -65,10 +65,10 @@ public:
     {
         const auto sourceSize = static_cast<vk::DeviceSize>(dataSrcSize);
         
-        const VulkanMemoryBuffer stagingBuffer(pool, VulkanMemoryBuffer::CreateInfo(sourceSize).setHostVisible().setTransferSrc());
+        const VulkanMemoryBuffer stagingBuffer(pool, VulkanMemoryBuffer::CreateInfo(sourceSize).setHostUpload().setTransferSrc());
         stagingBuffer.write(dataSrc, dataSrcSize);
 
-        VulkanBufferTransfer transfer(device, dest.getBuffer(), stagingBuffer.getBuffer());
+        VulkanBufferTransfer transfer(device, dest, stagingBuffer);
         
         transfer.writeToBuffer();
         transfer.waitForFence();
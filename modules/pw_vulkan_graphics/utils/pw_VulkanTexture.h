@@ -29,6 +29,14 @@ namespace parawave
 {
     
 //==============================================================================
+/** 
+    VulkanTexture
+
+    A sampled BGRA image. By default the image is device local with optimal tiling 
+    and its pixels are copied from a staging buffer. On devices with unified memory, 
+    a texture can use linear tiling instead. The host writes the pixels directly 
+    into the mapped image, which then only needs a layout transition.
+*/
 class VulkanTexture final : public juce::ReferenceCountedObject
 {
 public:
@@ -38,10 +46,9 @@ private:
     VulkanTexture() = delete;
 
 public:
-    VulkanTexture(const VulkanDevice& device, VulkanMemoryPool& memoryPool, uint32_t width_, uint32_t height_) :
-        width(width_), height(height_),
-        memoryImage(memoryPool, VulkanMemoryImage::CreateInfo(width, height, vk::Format::eB8G8R8A8Unorm)
-            .setDeviceLocal().setSampled().setTransferDst()),
+    VulkanTexture(const VulkanDevice& device, VulkanMemoryPool& memoryPool, uint32_t width_, uint32_t height_, bool linearTiling = false) :
+        width(width_), height(height_), linear(linearTiling),
+        memoryImage(memoryPool, getCreateInfo(width, height, linear)),
         imageView(device, memoryImage.getImage())   
     {
         //DBG("[Vulkan] Created cached image of size " << juce::String(width) << " x " << juce::String(height) << ".");
@@ -55,6 +62,30 @@ public:
     const VulkanMemoryImage& getMemory() const noexcept { return memoryImage; }
 
     const VulkanImageView& getImageView() const noexcept { return imageView; }
+
+    bool isLinear() const noexcept { return linear; }
+
+    /** Write the pixels of the image into a linear texture. The texture has to be transitioned 
+        from the preinitialized into the shader read only layout, before it can be sampled. */
+    void writeImage(const juce::Image& image) const
+    {
+        jassert(linear && memoryImage.isHostVisible());
+        jassert(image.getWidth() == static_cast<int>(width) && image.getHeight() == static_cast<int>(height));
+
+        const juce::Image::BitmapData bitmapData(image, juce::Image::BitmapData::readOnly);
+
+        switch (bitmapData.pixelFormat)
+        {
+            case juce::Image::ARGB:          writePixels<juce::PixelARGB>(bitmapData); break;
+            case juce::Image::RGB:           writePixels<juce::PixelRGB>(bitmapData); break;
+            case juce::Image::SingleChannel: writePixels<juce::PixelAlpha>(bitmapData); break;
+            case juce::Image::UnknownFormat:
+                PW_DBG_V("Format for juce::Image not implemented!");
+                jassertfalse; 
+            default: 
+                break;
+        }
+    }
         
     juce::Time getLastUsedTime() const noexcept { return lastUsed; }
 
@@ -68,10 +99,43 @@ public:
 
     static VulkanTexture::Ptr get(const juce::Graphics& g, const juce::Image& image);
 
+private:
+    static VulkanMemoryImage::CreateInfo getCreateInfo(uint32_t width, uint32_t height, bool linear) noexcept
+    {
+        auto createInfo = VulkanMemoryImage::CreateInfo(width, height, vk::Format::eB8G8R8A8Unorm)
+            .setDeviceLocal().setSampled().setTransferDst();
+
+        if (linear)
+            createInfo.setLinearTiling().setMemoryProperties(vk::MemoryPropertyFlagBits::eDeviceLocal | vk::MemoryPropertyFlagBits::eHostVisible);
+
+        return createInfo;
+    }
+
+    template <class PixelType>
+    void writePixels(const juce::Image::BitmapData& bitmapData) const
+    {
+        // Rows of a linear image can be padded, follow the row pitch of the driver
+        const auto layout = memoryImage.getImage().getSubresourceLayout();
+        auto* dstData = static_cast<uint8_t*>(memoryImage.getData()) + layout.offset;
+
+        for (int y = 0; y < bitmapData.height; ++y)
+        {
+            auto* src = reinterpret_cast<const PixelType*>(bitmapData.getLinePointer(y));
+            auto* dst = reinterpret_cast<juce::PixelARGB*>(dstData + layout.rowPitch * static_cast<vk::DeviceSize>(y));
+
+            for (int x = 0; x < bitmapData.width; ++x)
+                dst[x].set(src[x]);
+        }
+
+        memoryImage.flush(layout.offset, layout.rowPitch * static_cast<vk::DeviceSize>(bitmapData.height));
+    }
+
 private:
     const uint32_t width;
     const uint32_t height;
 
+    const bool linear;
+
     const VulkanMemoryImage memoryImage;
     const VulkanImageView imageView;
 